@@ -0,0 +1,314 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор A*, направляющий поиск Дейкстры к цели с помощью нижней оценки
+// веса оставшегося пути. Оценка bound(u, v) веса пути из u в v должна быть
+// согласованной: bound(u, t) <= w(u, v) + bound(v, t) и
+// bound(s, v) <= bound(s, u) + w(u, v) для каждого ребра u -> v. В
+// двунаправленном режиме поиски от начала и от конца используют усреднённые
+// потенциалы, поэтому остаются корректными при той же оценке
+template <typename Weight>
+class AStarRouter : public BaseRouter<Weight> {
+private:
+  using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+  using LowerBound = std::function<Weight(VertexId, VertexId)>;
+
+  AStarRouter(const Graph& graph, LowerBound lower_bound,
+    bool bidirectional = false);
+
+  std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+  static constexpr EdgeId NO_EDGE = detail::SearchState<Weight>::NO_EDGE;
+
+  using QueueItem = std::pair<Weight, VertexId>;
+
+  // Состояние одного направления поиска. Ключ вершины в куче равен её
+  // расстоянию плюс потенциал, потенциал вычисляется при первом достижении
+  struct SearchState {
+    detail::SearchState<Weight> labels;
+    std::vector<Weight> potentials;
+
+    void Reset(size_t vertex_count);
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge,
+      const std::function<Weight(VertexId)> &potential);
+
+    // Возвращает ключ ближайшей актуальной записи кучи
+    std::optional<QueueItem> Top();
+    std::optional<QueueItem> Pop();
+  };
+
+  static SearchState &GetForwardState();
+  static SearchState &GetBackwardState();
+
+  std::optional<RouteInfo> BuildForwardRoute(VertexId from, VertexId to) const;
+  std::optional<RouteInfo> BuildBidirectionalRoute(VertexId from,
+    VertexId to) const;
+
+  static constexpr Weight ZERO_WEIGHT{};
+  const Graph& graph_;
+  LowerBound lower_bound_;
+  std::optional<IncomingEdges<Weight>> incoming_edges_;
+};
+
+template <typename Weight>
+void AStarRouter<Weight>::SearchState::Reset(size_t vertex_count) {
+  labels.Reset(vertex_count);
+  if (potentials.size() < vertex_count) {
+    potentials.resize(vertex_count);
+  }
+}
+
+template <typename Weight>
+void AStarRouter<Weight>::SearchState::Reach(VertexId vertex, Weight weight,
+  EdgeId prev_edge, const std::function<Weight(VertexId)> &potential) {
+  if (!labels.IsReached(vertex)) {
+    potentials[vertex] = potential(vertex);
+  }
+  labels.Label(vertex, weight, prev_edge);
+  labels.queue.emplace_back(weight + potentials[vertex], vertex);
+  std::push_heap(labels.queue.begin(), labels.queue.end(),
+    std::greater<QueueItem>{});
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::QueueItem>
+AStarRouter<Weight>::SearchState::Top() {
+  auto &queue = labels.queue;
+  while (!queue.empty()) {
+    const auto [key, vertex] = queue.front();
+
+    // Устаревшая запись кучи: вершина уже достигнута более коротким путём
+    if (!(labels.weights[vertex] + potentials[vertex] < key)) {
+      return queue.front();
+    }
+    std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+    queue.pop_back();
+  }
+  return std::nullopt;
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::QueueItem>
+AStarRouter<Weight>::SearchState::Pop() {
+  const auto item = Top();
+  if (item) {
+    std::pop_heap(labels.queue.begin(), labels.queue.end(),
+      std::greater<QueueItem>{});
+    labels.queue.pop_back();
+  }
+  return item;
+}
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound lower_bound,
+  bool bidirectional)
+  : graph_(graph)
+  , lower_bound_(std::move(lower_bound))
+{
+  for (const Weight weight : graph.GetEdgeWeights()) {
+    if (weight < ZERO_WEIGHT) {
+      throw std::domain_error("Edges' weights should be non-negative");
+    }
+  }
+
+  if (bidirectional) {
+    incoming_edges_.emplace(graph);
+  }
+}
+
+template <typename Weight>
+typename AStarRouter<Weight>::SearchState &
+AStarRouter<Weight>::GetForwardState() {
+  static thread_local SearchState state;
+  return state;
+}
+
+template <typename Weight>
+typename AStarRouter<Weight>::SearchState &
+AStarRouter<Weight>::GetBackwardState() {
+  static thread_local SearchState state;
+  return state;
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+  const size_t vertex_count = graph_.GetVertexCount();
+  if (from >= vertex_count || to >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  return incoming_edges_ ? BuildBidirectionalRoute(from, to)
+    : BuildForwardRoute(from, to);
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildForwardRoute(VertexId from, VertexId to) const {
+  const std::function<Weight(VertexId)> potential =
+    [this, to](VertexId vertex) {
+      return lower_bound_(vertex, to);
+    };
+
+  auto &state = GetForwardState();
+  state.Reset(graph_.GetVertexCount());
+  state.Reach(from, ZERO_WEIGHT, NO_EDGE, potential);
+
+  auto &labels = state.labels;
+  while (const auto item = state.Pop()) {
+    const VertexId vertex = item->second;
+    if (vertex == to) {
+      break;
+    }
+
+    const Weight weight = labels.weights[vertex];
+    graph_.ForEachIncidentEdge(vertex,
+      [&](EdgeId edge_id, const Edge<Weight> &edge) {
+        const Weight candidate_weight = weight + edge.weight;
+        if (!labels.IsReached(edge.to)
+          || candidate_weight < labels.weights[edge.to]) {
+          state.Reach(edge.to, candidate_weight, edge_id, potential);
+        }
+      });
+  }
+
+  if (!labels.IsReached(to)) {
+    return std::nullopt;
+  }
+
+  std::vector<EdgeId> edges;
+  for (EdgeId edge_id = labels.prev_edges[to]; edge_id != NO_EDGE;
+    edge_id = labels.prev_edges[graph_.GetEdge(edge_id).from]) {
+    edges.push_back(edge_id);
+  }
+  std::reverse(edges.begin(), edges.end());
+
+  return RouteInfo{labels.weights[to], std::move(edges)};
+}
+
+// Потенциал прямого поиска p(v) = (bound(v, to) - bound(from, v)) / 2,
+// обратного -p(v). Поиск завершается, когда сумма ключей в вершинах куч не
+// меньше лучшего найденного маршрута
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildBidirectionalRoute(VertexId from,
+  VertexId to) const {
+  const std::function<Weight(VertexId)> forward_potential =
+    [this, from, to](VertexId vertex) {
+      return (lower_bound_(vertex, to) - lower_bound_(from, vertex)) / 2;
+    };
+  const std::function<Weight(VertexId)> backward_potential =
+    [this, from, to](VertexId vertex) {
+      return (lower_bound_(from, vertex) - lower_bound_(vertex, to)) / 2;
+    };
+
+  const size_t vertex_count = graph_.GetVertexCount();
+  auto &forward = GetForwardState();
+  auto &backward = GetBackwardState();
+  forward.Reset(vertex_count);
+  backward.Reset(vertex_count);
+  forward.Reach(from, ZERO_WEIGHT, NO_EDGE, forward_potential);
+  backward.Reach(to, ZERO_WEIGHT, NO_EDGE, backward_potential);
+
+  std::optional<Weight> best_weight;
+  VertexId meeting_vertex = from;
+  if (from == to) {
+    best_weight = ZERO_WEIGHT;
+  }
+
+  auto meet = [&best_weight, &meeting_vertex](VertexId vertex,
+    Weight candidate_weight) {
+    if (!best_weight || candidate_weight < *best_weight) {
+      best_weight = candidate_weight;
+      meeting_vertex = vertex;
+    }
+  };
+
+  while (true) {
+    const auto forward_top = forward.Top();
+    const auto backward_top = backward.Top();
+    if (!forward_top || !backward_top || (best_weight
+      && !(forward_top->first + backward_top->first < *best_weight))) {
+      break;
+    }
+
+    if (!(backward_top->first < forward_top->first)) {
+      const VertexId vertex = forward.Pop()->second;
+      const Weight weight = forward.labels.weights[vertex];
+      graph_.ForEachIncidentEdge(vertex,
+        [&](EdgeId edge_id, const Edge<Weight> &edge) {
+          const Weight candidate_weight = weight + edge.weight;
+          if (!forward.labels.IsReached(edge.to)
+            || candidate_weight < forward.labels.weights[edge.to]) {
+            forward.Reach(edge.to, candidate_weight, edge_id,
+              forward_potential);
+            if (backward.labels.IsReached(edge.to)) {
+              meet(edge.to,
+                candidate_weight + backward.labels.weights[edge.to]);
+            }
+          }
+        });
+    } else {
+      const VertexId vertex = backward.Pop()->second;
+      const Weight weight = backward.labels.weights[vertex];
+      incoming_edges_->ForEach(vertex,
+        [&](EdgeId edge_id, const Edge<Weight> &edge) {
+          const Weight candidate_weight = weight + edge.weight;
+          if (!backward.labels.IsReached(edge.from)
+            || candidate_weight < backward.labels.weights[edge.from]) {
+            backward.Reach(edge.from, candidate_weight, edge_id,
+              backward_potential);
+            if (forward.labels.IsReached(edge.from)) {
+              meet(edge.from,
+                forward.labels.weights[edge.from] + candidate_weight);
+            }
+          }
+        });
+    }
+  }
+
+  if (!best_weight) {
+    return std::nullopt;
+  }
+
+  std::vector<EdgeId> edges;
+  for (EdgeId edge_id = forward.labels.prev_edges[meeting_vertex];
+    edge_id != NO_EDGE;
+    edge_id = forward.labels.prev_edges[graph_.GetEdge(edge_id).from]) {
+    edges.push_back(edge_id);
+  }
+  std::reverse(edges.begin(), edges.end());
+  for (EdgeId edge_id = backward.labels.prev_edges[meeting_vertex];
+    edge_id != NO_EDGE;
+    edge_id = backward.labels.prev_edges[graph_.GetEdge(edge_id).to]) {
+    edges.push_back(edge_id);
+  }
+
+  // Вес маршрута пересчитывается по рёбрам в порядке следования, как и при
+  // поиске Дейкстры
+  Weight weight = ZERO_WEIGHT;
+  for (const EdgeId edge_id : edges) {
+    weight = weight + graph_.GetEdge(edge_id).weight;
+  }
+
+  return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace graph {
+
+// Рёбра, исключаемые из поиска без перестроения графа и предварительных
+// расчётов маршрутизаторов. Закрытая вершина закрывает все входящие и
+// исходящие рёбра, закрытая линия - все свои рёбра, кроме лежащих внутри
+// оставленных открытыми участков
+class ClosedEdges {
+public:
+  ClosedEdges() = default;
+
+  // open_spans - участки закрытых линий, рёбра begin -> end внутри которых
+  // остаются открытыми, если их концы не закрыты
+  template <typename Weight>
+  ClosedEdges(const DirectedWeightedGraph<Weight> &graph,
+    const std::vector<VertexId> &closed_vertices,
+    const std::vector<size_t> &closed_lines,
+    const std::vector<LineEdge> &open_spans);
+
+  bool IsClosed(EdgeId edge_id) const;
+  bool IsEmpty() const;
+  size_t GetClosedCount() const;
+
+private:
+  std::vector<bool> closed_;
+  size_t closed_count_ = 0;
+};
+
+template <typename Weight>
+ClosedEdges::ClosedEdges(const DirectedWeightedGraph<Weight> &graph,
+  const std::vector<VertexId> &closed_vertices,
+  const std::vector<size_t> &closed_lines,
+  const std::vector<LineEdge> &open_spans) {
+  if (closed_vertices.empty() && closed_lines.empty()) {
+    return;
+  }
+
+  const size_t vertex_count = graph.GetVertexCount();
+  std::vector<bool> is_vertex_closed(vertex_count, false);
+  for (const VertexId vertex : closed_vertices) {
+    is_vertex_closed.at(vertex) = true;
+  }
+
+  closed_.assign(graph.GetEdgeCount(), false);
+  auto close = [this](EdgeId edge_id) {
+    if (!closed_[edge_id]) {
+      closed_[edge_id] = true;
+      ++closed_count_;
+    }
+  };
+
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    graph.ForEachExplicitEdge(vertex,
+      [&close, &is_vertex_closed](EdgeId edge_id, const Edge<Weight> &edge) {
+        if (is_vertex_closed[edge.from] || is_vertex_closed[edge.to]) {
+          close(edge_id);
+        }
+      });
+  }
+
+  // Рёбра линии с закрытым началом занимают строку треугольной матрицы
+  // номеров, с закрытым концом - столбец
+  const auto &lines = graph.GetLines();
+  for (size_t line_id = 0; line_id < lines.size(); ++line_id) {
+    const auto &line = lines[line_id];
+    for (size_t position = 0; position < line.GetSize(); ++position) {
+      if (is_vertex_closed[line.from[position]]) {
+        for (size_t end = position + 1; end < line.GetSize(); ++end) {
+          close(graph.GetLineEdgeId(line_id, position, end));
+        }
+      }
+      if (is_vertex_closed[line.to[position]]) {
+        for (size_t begin = 0; begin < position; ++begin) {
+          close(graph.GetLineEdgeId(line_id, begin, position));
+        }
+      }
+    }
+  }
+
+  std::vector<std::vector<LineEdge>> line_open_spans(lines.size());
+  for (const auto &span : open_spans) {
+    line_open_spans.at(span.line).push_back(span);
+  }
+  for (const size_t line_id : closed_lines) {
+    const size_t size = lines.at(line_id).GetSize();
+    const auto &spans = line_open_spans[line_id];
+    for (size_t begin = 0; begin < size; ++begin) {
+      for (size_t end = begin + 1; end < size; ++end) {
+        const bool is_open = std::any_of(spans.begin(), spans.end(),
+          [begin, end](const LineEdge &span) {
+            return span.begin <= begin && end <= span.end;
+          });
+        if (!is_open) {
+          close(graph.GetLineEdgeId(line_id, begin, end));
+        }
+      }
+    }
+  }
+}
+
+inline bool ClosedEdges::IsClosed(EdgeId edge_id) const {
+  return !closed_.empty() && closed_[edge_id];
+}
+
+inline bool ClosedEdges::IsEmpty() const {
+  return closed_count_ == 0;
+}
+
+inline size_t ClosedEdges::GetClosedCount() const {
+  return closed_count_;
+}
+
+}  // namespace graph
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Разбиение вершин графа на слабо связные компоненты: вершины, связанные
+// путём без учёта направления рёбер, получают одинаковую метку. Если метки
+// вершин различаются, пути между ними нет ни в одном направлении, поэтому
+// такие запросы отклоняются без поиска. Сильно связные компоненты для этого
+// не подходят: путь из одной в другую может существовать
+class ConnectedComponents {
+public:
+  using Label = uint32_t;
+
+  ConnectedComponents() = default;
+
+  template <typename Weight>
+  explicit ConnectedComponents(const DirectedWeightedGraph<Weight> &graph);
+
+  // Восстанавливает разбиение по ранее рассчитанным меткам вершин
+  template <typename Weight>
+  ConnectedComponents(const DirectedWeightedGraph<Weight> &graph,
+    std::vector<Label> labels);
+
+  // Возвращает false, только если пути из from в to заведомо нет. Без
+  // рассчитанных меток считается, что путь может существовать
+  bool MayBeConnected(VertexId from, VertexId to) const;
+
+  size_t GetComponentCount() const;
+  const std::vector<Label> &GetLabels() const;
+
+private:
+  std::vector<Label> labels_;
+  size_t component_count_ = 0;
+};
+
+// Компоненты находятся системой непересекающихся множеств. Неявные рёбра
+// линии не перебираются: рёбра из первой позиции во все последующие и из всех
+// позиций в последнюю связывают те же вершины
+template <typename Weight>
+ConnectedComponents::ConnectedComponents(
+  const DirectedWeightedGraph<Weight> &graph) {
+  const size_t vertex_count = graph.GetVertexCount();
+  std::vector<VertexId> parents(vertex_count);
+  std::iota(parents.begin(), parents.end(), VertexId{0});
+
+  auto find_root = [&parents](VertexId vertex) {
+    while (parents[vertex] != vertex) {
+      parents[vertex] = parents[parents[vertex]];
+      vertex = parents[vertex];
+    }
+    return vertex;
+  };
+  auto unite = [&parents, &find_root](VertexId lhs, VertexId rhs) {
+    lhs = find_root(lhs);
+    rhs = find_root(rhs);
+    if (lhs != rhs) {
+      parents[std::max(lhs, rhs)] = std::min(lhs, rhs);
+    }
+  };
+
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    graph.ForEachExplicitEdge(vertex, [&unite](EdgeId, const Edge<Weight> &edge) {
+      unite(edge.from, edge.to);
+    });
+  }
+  for (const auto &line : graph.GetLines()) {
+    const size_t last = line.GetSize() - 1;
+    for (size_t position = 0; position < last; ++position) {
+      unite(line.from[0], line.to[position + 1]);
+      unite(line.from[position], line.to[last]);
+    }
+  }
+
+  // Метки нумеруются подряд в порядке первых вершин компонент
+  std::vector<Label> root_labels(vertex_count);
+  labels_.resize(vertex_count);
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    const VertexId root = find_root(vertex);
+    if (root == vertex) {
+      root_labels[root] = static_cast<Label>(component_count_++);
+    }
+    labels_[vertex] = root_labels[root];
+  }
+}
+
+template <typename Weight>
+ConnectedComponents::ConnectedComponents(
+  const DirectedWeightedGraph<Weight> &graph, std::vector<Label> labels)
+  : labels_(std::move(labels)) {
+  if (labels_.size() != graph.GetVertexCount()) {
+    throw std::invalid_argument("Components labels don't match the graph");
+  }
+  for (const Label label : labels_) {
+    component_count_ = std::max(component_count_, size_t{label} + 1);
+  }
+}
+
+inline bool ConnectedComponents::MayBeConnected(VertexId from,
+  VertexId to) const {
+  return labels_.empty() || labels_[from] == labels_[to];
+}
+
+inline size_t ConnectedComponents::GetComponentCount() const {
+  return component_count_;
+}
+
+inline const std::vector<ConnectedComponents::Label> &
+ConnectedComponents::GetLabels() const {
+  return labels_;
+}
+
+}  // namespace graph
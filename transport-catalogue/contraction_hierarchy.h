@@ -0,0 +1,586 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор на основе иерархии сжатия (Contraction Hierarchies). При
+// построении вершины графа по очереди «сжимаются»: кратчайшие пути через
+// сжимаемую вершину заменяются дугами-сокращениями между её соседями. Запрос
+// выполняется двунаправленным поиском только по дугам, ведущим к вершинам
+// более высокого ранга, а найденные сокращения разворачиваются в рёбра графа.
+// Если оставшийся граф становится слишком плотным, сжатие прекращается, а
+// оставшиеся вершины образуют ядро, внутри которого поиск идёт по всем дугам
+template <typename Weight>
+class ContractionHierarchy : public BaseRouter<Weight> {
+private:
+  using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+  // Дуга иерархии. Идентификаторы дуг [0, E) совпадают с идентификаторами
+  // рёбер графа, идентификатор сокращения с номером i равен E + i
+  using ArcId = EdgeId;
+
+  // Сокращение, заменяющее путь из двух дуг first и second
+  struct Shortcut {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+    ArcId first;
+    ArcId second;
+  };
+
+  struct HierarchyData {
+    std::vector<uint32_t> ranks;
+    std::vector<Shortcut> shortcuts;
+  };
+
+  explicit ContractionHierarchy(const Graph& graph);
+
+  // Восстанавливает иерархию по ранее рассчитанным данным без повторного
+  // сжатия графа
+  ContractionHierarchy(const Graph& graph, HierarchyData hierarchy_data);
+
+  std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const override;
+
+  const HierarchyData &GetHierarchyData() const;
+
+  // Оценка наибольшего объёма памяти при сжатии графа, в байтах. Число
+  // сокращений заранее неизвестно и принимается равным числу рёбер
+  static size_t EstimateMemoryUsage(const Graph& graph);
+
+private:
+  static constexpr ArcId NO_ARC = detail::SearchState<Weight>::NO_EDGE;
+
+  // Максимальное число вершин, просматриваемых при поиске пути-свидетеля.
+  // Если свидетель не найден за это число шагов, сокращение добавляется
+  static constexpr size_t WITNESS_SETTLE_LIMIT = 100;
+
+  // Сжатие прекращается, когда средняя степень оставшихся вершин превышает
+  // исходную во столько раз
+  static constexpr double CORE_DEGREE_FACTOR = 4;
+
+  struct Arc {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+  };
+
+  // Дуга в списке смежности: соседняя вершина и вес хранятся рядом с
+  // идентификатором, чтобы поиск не обращался к графу за каждой дугой
+  struct AdjacentArc {
+    ArcId id;
+    VertexId neighbor;
+    Weight weight;
+  };
+
+  // Смежность в сжатом построчном виде: дуги вершины v занимают
+  // arcs[offsets[v], offsets[v + 1])
+  struct Adjacency {
+    std::vector<size_t> offsets;
+    std::vector<AdjacentArc> arcs;
+  };
+
+  // Состояние графа во время сжатия. Дуги графа и сокращений хранятся явно,
+  // так как рёбра линий графа вычисляются при каждом обращении
+  struct ContractionState {
+    std::vector<Arc> arcs;
+    std::vector<std::vector<ArcId>> out_arcs;
+    std::vector<std::vector<ArcId>> in_arcs;
+    std::vector<bool> contracted;
+    std::vector<int> contracted_neighbors;
+    detail::SearchState<Weight> witness_search;
+  };
+
+  Arc GetArc(ArcId arc_id) const;
+  std::vector<Arc> CollectArcs() const;
+  ArcId AddShortcut(ContractionState &state, const Shortcut &shortcut);
+
+  // Сжимает граф и возвращает все дуги иерархии
+  std::vector<Arc> Contract();
+  std::vector<Shortcut> FindShortcuts(ContractionState &state,
+    VertexId vertex);
+  int ComputePriority(ContractionState &state, VertexId vertex);
+  void FindWitnesses(ContractionState &state, VertexId source,
+    VertexId excluded, Weight max_weight);
+
+  // Дуги внутри ядра (между вершинами равного ранга) используются поиском в
+  // обоих направлениях
+  bool IsUpwardArc(const Arc &arc) const;
+  bool IsDownwardArc(const Arc &arc) const;
+  void BuildSearchGraphs(const std::vector<Arc> &arcs);
+  void UnpackArc(ArcId arc_id, std::vector<EdgeId> &edges) const;
+
+  static constexpr Weight ZERO_WEIGHT{};
+  const Graph& graph_;
+  HierarchyData hierarchy_data_;
+  Adjacency upward_;    // Дуги v -> w, где ранг w выше ранга v
+  Adjacency downward_;  // Дуги w -> v, где ранг w выше ранга v, по вершине v
+};
+
+// При сжатии каждая дуга хранится явно и входит в списки исходящих и
+// входящих дуг, после сжатия - в списки поиска вверх или вниз
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::EstimateMemoryUsage(const Graph& graph) {
+  const size_t arc_count = 2 * graph.GetEdgeCount();
+  return arc_count * (sizeof(Arc) + 2 * sizeof(ArcId) + sizeof(AdjacentArc))
+    + graph.GetEdgeCount() * sizeof(Shortcut)
+    + graph.GetVertexCount() * (sizeof(uint32_t) + 4 * sizeof(size_t));
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+  : graph_(graph)
+{
+  BuildSearchGraphs(Contract());
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph,
+  HierarchyData hierarchy_data)
+  : graph_(graph)
+  , hierarchy_data_(std::move(hierarchy_data))
+{
+  const size_t arc_count =
+    graph.GetEdgeCount() + hierarchy_data_.shortcuts.size();
+  if (hierarchy_data_.ranks.size() != graph.GetVertexCount()) {
+    throw std::invalid_argument("Hierarchy data doesn't match the graph");
+  }
+  for (ArcId arc_id = graph.GetEdgeCount(); arc_id < arc_count; ++arc_id) {
+    const auto &shortcut =
+      hierarchy_data_.shortcuts[arc_id - graph.GetEdgeCount()];
+    if (shortcut.first >= arc_id || shortcut.second >= arc_id) {
+      throw std::invalid_argument("Hierarchy data doesn't match the graph");
+    }
+  }
+
+  BuildSearchGraphs(CollectArcs());
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::HierarchyData &
+ContractionHierarchy<Weight>::GetHierarchyData() const {
+  return hierarchy_data_;
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::Arc
+ContractionHierarchy<Weight>::GetArc(ArcId arc_id) const {
+  if (arc_id < graph_.GetEdgeCount()) {
+    const auto &edge = graph_.GetEdge(arc_id);
+    return {edge.from, edge.to, edge.weight};
+  }
+  const auto &shortcut =
+    hierarchy_data_.shortcuts[arc_id - graph_.GetEdgeCount()];
+  return {shortcut.from, shortcut.to, shortcut.weight};
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Arc>
+ContractionHierarchy<Weight>::CollectArcs() const {
+  std::vector<Arc> arcs(graph_.GetEdgeCount());
+  for (VertexId vertex = 0; vertex < graph_.GetVertexCount(); ++vertex) {
+    graph_.ForEachIncidentEdge(vertex,
+      [&arcs](EdgeId edge_id, const Edge<Weight> &edge) {
+        if (edge.weight < ZERO_WEIGHT) {
+          throw std::domain_error("Edges' weights should be non-negative");
+        }
+        arcs[edge_id] = {edge.from, edge.to, edge.weight};
+      });
+  }
+  for (const auto &shortcut : hierarchy_data_.shortcuts) {
+    arcs.push_back({shortcut.from, shortcut.to, shortcut.weight});
+  }
+  return arcs;
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::ArcId
+ContractionHierarchy<Weight>::AddShortcut(ContractionState &state,
+  const Shortcut &shortcut) {
+  const ArcId arc_id = state.arcs.size();
+  hierarchy_data_.shortcuts.push_back(shortcut);
+  state.arcs.push_back({shortcut.from, shortcut.to, shortcut.weight});
+  state.out_arcs[shortcut.from].push_back(arc_id);
+  state.in_arcs[shortcut.to].push_back(arc_id);
+  return arc_id;
+}
+
+// Ищет пути из source, не проходящие через excluded и сжатые вершины, длиной
+// не больше max_weight. Найденные в witness_search расстояния являются длинами
+// существующих путей, поэтому по ним можно судить о наличии свидетеля
+template <typename Weight>
+void ContractionHierarchy<Weight>::FindWitnesses(ContractionState &state,
+  VertexId source, VertexId excluded, Weight max_weight) {
+  auto &search = state.witness_search;
+  search.Reset(graph_.GetVertexCount());
+  search.Reach(source, ZERO_WEIGHT, NO_ARC);
+
+  size_t settled_count = 0;
+  while (const auto item = search.Pop()) {
+    const auto [weight, vertex] = *item;
+    if (max_weight < weight || ++settled_count > WITNESS_SETTLE_LIMIT) {
+      return;
+    }
+
+    for (const ArcId arc_id : state.out_arcs[vertex]) {
+      const Arc &arc = state.arcs[arc_id];
+      if (arc.to == excluded || state.contracted[arc.to]) {
+        continue;
+      }
+      const Weight candidate_weight = weight + arc.weight;
+      if (!(max_weight < candidate_weight) && (!search.IsReached(arc.to)
+        || candidate_weight < search.weights[arc.to])) {
+        search.Reach(arc.to, candidate_weight, arc_id);
+      }
+    }
+  }
+}
+
+// Возвращает сокращения, необходимые для сжатия вершины vertex
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Shortcut>
+ContractionHierarchy<Weight>::FindShortcuts(ContractionState &state,
+  VertexId vertex) {
+  std::vector<Shortcut> shortcuts;
+
+  for (const ArcId in_arc_id : state.in_arcs[vertex]) {
+    const Arc &in_arc = state.arcs[in_arc_id];
+    if (in_arc.from == vertex || state.contracted[in_arc.from]) {
+      continue;
+    }
+
+    // Один поиск свидетелей на входящую дугу, ограниченный самым длинным из
+    // возможных сокращений
+    std::optional<Weight> max_weight;
+    for (const ArcId out_arc_id : state.out_arcs[vertex]) {
+      const Arc &out_arc = state.arcs[out_arc_id];
+      if (out_arc.to != vertex && out_arc.to != in_arc.from
+        && !state.contracted[out_arc.to]) {
+        const Weight weight = in_arc.weight + out_arc.weight;
+        max_weight = max_weight ? std::max(*max_weight, weight) : weight;
+      }
+    }
+    if (!max_weight) {
+      continue;
+    }
+    FindWitnesses(state, in_arc.from, vertex, *max_weight);
+
+    const auto &search = state.witness_search;
+    for (const ArcId out_arc_id : state.out_arcs[vertex]) {
+      const Arc &out_arc = state.arcs[out_arc_id];
+      if (out_arc.to == vertex || out_arc.to == in_arc.from
+        || state.contracted[out_arc.to]) {
+        continue;
+      }
+
+      const Weight weight = in_arc.weight + out_arc.weight;
+      if (!search.IsReached(out_arc.to)
+        || weight < search.weights[out_arc.to]) {
+        shortcuts.push_back({in_arc.from, out_arc.to, weight,
+          in_arc_id, out_arc_id});
+      }
+    }
+  }
+  return shortcuts;
+}
+
+// Приоритет сжатия: разность числа добавляемых сокращений и числа удаляемых
+// дуг плюс число уже сжатых соседей для равномерности сжатия
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(ContractionState &state,
+  VertexId vertex) {
+  int removed_arc_count = 0;
+  for (const ArcId arc_id : state.in_arcs[vertex]) {
+    removed_arc_count += !state.contracted[state.arcs[arc_id].from];
+  }
+  for (const ArcId arc_id : state.out_arcs[vertex]) {
+    removed_arc_count += !state.contracted[state.arcs[arc_id].to];
+  }
+  const int shortcut_count =
+    static_cast<int>(FindShortcuts(state, vertex).size());
+  return shortcut_count - removed_arc_count
+    + state.contracted_neighbors[vertex];
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Arc>
+ContractionHierarchy<Weight>::Contract() {
+  const size_t vertex_count = graph_.GetVertexCount();
+  if (vertex_count >= std::numeric_limits<uint32_t>::max()) {
+    throw std::overflow_error("Too many vertices for contraction");
+  }
+
+  ContractionState state;
+  state.arcs = CollectArcs();
+  state.out_arcs.resize(vertex_count);
+  state.in_arcs.resize(vertex_count);
+  state.contracted.assign(vertex_count, false);
+  state.contracted_neighbors.assign(vertex_count, 0);
+  hierarchy_data_.ranks.assign(vertex_count, 0);
+
+  for (ArcId arc_id = 0; arc_id < state.arcs.size(); ++arc_id) {
+    const Arc &arc = state.arcs[arc_id];
+    if (arc.from != arc.to) {
+      state.out_arcs[arc.from].push_back(arc_id);
+      state.in_arcs[arc.to].push_back(arc_id);
+    }
+  }
+
+  // Очередь сжатия с ленивым обновлением: приоритет извлечённой вершины
+  // пересчитывается, и если он стал хуже следующего, вершина возвращается
+  using QueueItem = std::pair<int, VertexId>;
+  std::vector<QueueItem> queue;
+  queue.reserve(vertex_count);
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    // Начальный приоритет оценивается без поиска свидетелей по худшему случаю,
+    // точное значение вычисляется при извлечении вершины из очереди
+    const int in_count = static_cast<int>(state.in_arcs[vertex].size());
+    const int out_count = static_cast<int>(state.out_arcs[vertex].size());
+    queue.emplace_back(in_count * out_count - in_count - out_count, vertex);
+  }
+  std::make_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+
+  size_t active_arc_count = 0;
+  for (const auto &arcs : state.out_arcs) {
+    active_arc_count += arcs.size();
+  }
+  const double max_core_arc_count_per_vertex =
+    CORE_DEGREE_FACTOR * std::max(
+      static_cast<double>(active_arc_count) / std::max<size_t>(vertex_count, 1),
+      1.0);
+
+  uint32_t rank = 0;
+  while (!queue.empty()) {
+    if (active_arc_count > max_core_arc_count_per_vertex * queue.size()) {
+      break;
+    }
+
+    std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+    const VertexId vertex = queue.back().second;
+    queue.pop_back();
+
+    const int priority = ComputePriority(state, vertex);
+    if (!queue.empty() && queue.front().first < priority) {
+      queue.emplace_back(priority, vertex);
+      std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+      continue;
+    }
+
+    const auto shortcuts = FindShortcuts(state, vertex);
+    for (const auto &shortcut : shortcuts) {
+      AddShortcut(state, shortcut);
+    }
+    active_arc_count += shortcuts.size();
+    active_arc_count -= state.in_arcs[vertex].size()
+      + state.out_arcs[vertex].size();
+    state.contracted[vertex] = true;
+    hierarchy_data_.ranks[vertex] = rank++;
+
+    // Дуги сжатой вершины удаляются из списков её соседей, чтобы не
+    // просматривать их при дальнейших поисках свидетелей
+    auto is_contracted_arc = [&state](ArcId arc_id) {
+      const Arc &arc = state.arcs[arc_id];
+      return state.contracted[arc.from] || state.contracted[arc.to];
+    };
+    for (const ArcId arc_id : state.in_arcs[vertex]) {
+      auto &neighbor_arcs = state.out_arcs[state.arcs[arc_id].from];
+      ++state.contracted_neighbors[state.arcs[arc_id].from];
+      neighbor_arcs.erase(std::remove_if(neighbor_arcs.begin(),
+        neighbor_arcs.end(), is_contracted_arc), neighbor_arcs.end());
+    }
+    for (const ArcId arc_id : state.out_arcs[vertex]) {
+      auto &neighbor_arcs = state.in_arcs[state.arcs[arc_id].to];
+      ++state.contracted_neighbors[state.arcs[arc_id].to];
+      neighbor_arcs.erase(std::remove_if(neighbor_arcs.begin(),
+        neighbor_arcs.end(), is_contracted_arc), neighbor_arcs.end());
+    }
+    state.in_arcs[vertex].clear();
+    state.out_arcs[vertex].clear();
+    state.in_arcs[vertex].shrink_to_fit();
+    state.out_arcs[vertex].shrink_to_fit();
+  }
+
+  // Несжатые вершины ядра получают общий наивысший ранг
+  for (const auto &[priority, vertex] : queue) {
+    hierarchy_data_.ranks[vertex] = rank;
+  }
+  return std::move(state.arcs);
+}
+
+template <typename Weight>
+bool ContractionHierarchy<Weight>::IsUpwardArc(const Arc &arc) const {
+  const auto &ranks = hierarchy_data_.ranks;
+  return arc.from != arc.to && ranks[arc.from] <= ranks[arc.to];
+}
+
+template <typename Weight>
+bool ContractionHierarchy<Weight>::IsDownwardArc(const Arc &arc) const {
+  const auto &ranks = hierarchy_data_.ranks;
+  return arc.from != arc.to && ranks[arc.to] <= ranks[arc.from];
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraphs(
+  const std::vector<Arc> &arcs) {
+  const size_t vertex_count = graph_.GetVertexCount();
+  const size_t arc_count = arcs.size();
+
+  upward_.offsets.assign(vertex_count + 1, 0);
+  downward_.offsets.assign(vertex_count + 1, 0);
+  for (ArcId arc_id = 0; arc_id < arc_count; ++arc_id) {
+    const Arc &arc = arcs[arc_id];
+    if (IsUpwardArc(arc)) {
+      ++upward_.offsets[arc.from + 1];
+    }
+    if (IsDownwardArc(arc)) {
+      ++downward_.offsets[arc.to + 1];
+    }
+  }
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    upward_.offsets[vertex + 1] += upward_.offsets[vertex];
+    downward_.offsets[vertex + 1] += downward_.offsets[vertex];
+  }
+
+  upward_.arcs.resize(upward_.offsets.back());
+  downward_.arcs.resize(downward_.offsets.back());
+  std::vector<size_t> upward_next(upward_.offsets.begin(),
+    upward_.offsets.end() - 1);
+  std::vector<size_t> downward_next(downward_.offsets.begin(),
+    downward_.offsets.end() - 1);
+  for (ArcId arc_id = 0; arc_id < arc_count; ++arc_id) {
+    const Arc &arc = arcs[arc_id];
+    if (IsUpwardArc(arc)) {
+      upward_.arcs[upward_next[arc.from]++] = {arc_id, arc.to, arc.weight};
+    }
+    if (IsDownwardArc(arc)) {
+      downward_.arcs[downward_next[arc.to]++] = {arc_id, arc.from, arc.weight};
+    }
+  }
+}
+
+// Разворачивает дугу иерархии в последовательность рёбер исходного графа
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(ArcId arc_id,
+  std::vector<EdgeId> &edges) const {
+  std::vector<ArcId> stack{arc_id};
+  while (!stack.empty()) {
+    const ArcId current = stack.back();
+    stack.pop_back();
+
+    if (current < graph_.GetEdgeCount()) {
+      edges.push_back(current);
+    } else {
+      const auto &shortcut =
+        hierarchy_data_.shortcuts[current - graph_.GetEdgeCount()];
+      stack.push_back(shortcut.second);
+      stack.push_back(shortcut.first);
+    }
+  }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+  const size_t vertex_count = graph_.GetVertexCount();
+  if (from >= vertex_count || to >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  static thread_local detail::SearchState<Weight> forward;
+  static thread_local detail::SearchState<Weight> backward;
+  forward.Reset(vertex_count);
+  backward.Reset(vertex_count);
+  forward.Reach(from, ZERO_WEIGHT, NO_ARC);
+  backward.Reach(to, ZERO_WEIGHT, NO_ARC);
+
+  std::optional<Weight> best_weight;
+  VertexId meeting_vertex = from;
+
+  // Поиск в каждом направлении продолжается, пока расстояние до ближайшей
+  // вершины в его очереди меньше лучшего найденного маршрута
+  auto step = [this, &best_weight, &meeting_vertex](
+    detail::SearchState<Weight> &search,
+    const detail::SearchState<Weight> &opposite, const Adjacency &adjacency) {
+    const auto item = search.Pop();
+    if (!item || (best_weight && !(item->first < *best_weight))) {
+      search.queue.clear();
+      return;
+    }
+    const auto [weight, vertex] = *item;
+
+    if (opposite.IsReached(vertex)) {
+      const Weight candidate_weight = weight + opposite.weights[vertex];
+      if (!best_weight || candidate_weight < *best_weight) {
+        best_weight = candidate_weight;
+        meeting_vertex = vertex;
+      }
+    }
+
+    for (size_t i = adjacency.offsets[vertex];
+      i < adjacency.offsets[vertex + 1]; ++i) {
+      const AdjacentArc &arc = adjacency.arcs[i];
+      const Weight candidate_weight = weight + arc.weight;
+      if (!search.IsReached(arc.neighbor)
+        || candidate_weight < search.weights[arc.neighbor]) {
+        search.Reach(arc.neighbor, candidate_weight, arc.id);
+      }
+    }
+  };
+
+  while (!forward.queue.empty() || !backward.queue.empty()) {
+    const bool is_forward_turn = backward.queue.empty()
+      || (!forward.queue.empty()
+        && !(backward.queue.front().first < forward.queue.front().first));
+    if (is_forward_turn) {
+      step(forward, backward, upward_);
+    } else {
+      step(backward, forward, downward_);
+    }
+  }
+
+  if (!best_weight) {
+    return std::nullopt;
+  }
+
+  // Дуги от начальной вершины до точки встречи и от неё до конечной вершины
+  std::vector<ArcId> arcs;
+  for (ArcId arc_id = forward.prev_edges[meeting_vertex]; arc_id != NO_ARC;
+    arc_id = forward.prev_edges[GetArc(arc_id).from]) {
+    arcs.push_back(arc_id);
+  }
+  std::reverse(arcs.begin(), arcs.end());
+  for (ArcId arc_id = backward.prev_edges[meeting_vertex]; arc_id != NO_ARC;
+    arc_id = backward.prev_edges[GetArc(arc_id).to]) {
+    arcs.push_back(arc_id);
+  }
+
+  // Вес маршрута пересчитывается по рёбрам графа в порядке следования, как и
+  // при поиске Дейкстры, чтобы не зависеть от порядка сложения в сокращениях
+  std::vector<EdgeId> edges;
+  for (const ArcId arc_id : arcs) {
+    UnpackArc(arc_id, edges);
+  }
+  Weight weight = ZERO_WEIGHT;
+  for (const EdgeId edge_id : edges) {
+    weight = weight + graph_.GetEdge(edge_id).weight;
+  }
+
+  return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
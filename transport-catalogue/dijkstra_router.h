@@ -0,0 +1,314 @@
+#pragma once
+
+#include "closed_edges.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+namespace detail {
+
+// Рабочие буферы поиска Дейкстры. Вместо очистки массивов на каждый запрос
+// используется номер поколения: значение вершины актуально, только если её
+// метка совпадает с текущим поколением
+template <typename Weight>
+struct SearchState {
+  static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+
+  using QueueItem = std::pair<Weight, VertexId>;
+
+  std::vector<Weight> weights;
+  std::vector<EdgeId> prev_edges;
+  std::vector<uint32_t> marks;
+  std::vector<QueueItem> queue;
+  uint32_t generation = 0;
+
+  void Reset(size_t vertex_count);
+  bool IsReached(VertexId vertex) const;
+
+  // Записывает метку вершины без добавления в кучу
+  void Label(VertexId vertex, Weight weight, EdgeId prev_edge);
+  void Reach(VertexId vertex, Weight weight, EdgeId prev_edge);
+
+  // Извлекает из кучи ближайшую вершину, пропуская устаревшие записи
+  std::optional<QueueItem> Pop();
+};
+
+template <typename Weight>
+void SearchState<Weight>::Reset(size_t vertex_count) {
+  if (marks.size() < vertex_count) {
+    weights.resize(vertex_count);
+    prev_edges.resize(vertex_count);
+    marks.resize(vertex_count, 0);
+  }
+  queue.clear();
+
+  // При переполнении счётчика поколений метки сбрасываются явно
+  if (++generation == 0) {
+    std::fill(marks.begin(), marks.end(), 0);
+    generation = 1;
+  }
+}
+
+template <typename Weight>
+bool SearchState<Weight>::IsReached(VertexId vertex) const {
+  return marks[vertex] == generation;
+}
+
+template <typename Weight>
+void SearchState<Weight>::Label(VertexId vertex, Weight weight,
+  EdgeId prev_edge) {
+  marks[vertex] = generation;
+  weights[vertex] = weight;
+  prev_edges[vertex] = prev_edge;
+}
+
+template <typename Weight>
+void SearchState<Weight>::Reach(VertexId vertex, Weight weight,
+  EdgeId prev_edge) {
+  Label(vertex, weight, prev_edge);
+  queue.emplace_back(weight, vertex);
+  std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+}
+
+template <typename Weight>
+std::optional<typename SearchState<Weight>::QueueItem>
+SearchState<Weight>::Pop() {
+  while (!queue.empty()) {
+    std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+    const QueueItem item = queue.back();
+    queue.pop_back();
+
+    // Устаревшая запись кучи: вершина уже достигнута более коротким путём
+    if (!(weights[item.second] < item.first)) {
+      return item;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace detail
+
+// Маршрутизатор, выполняющий поиск Дейкстры с двоичной кучей на каждый запрос.
+// Не требует предварительного расчёта и памяти O(V^2): рабочие буферы
+// выделяются один раз на поток и переиспользуются между запросами
+template <typename Weight>
+class DijkstraRouter : public BaseRouter<Weight> {
+private:
+  using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+  explicit DijkstraRouter(const Graph& graph);
+
+  std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+  static constexpr Weight ZERO_WEIGHT{};
+  const Graph& graph_;
+};
+
+// Поиск Дейкстры кратчайшего маршрута при весах рёбер, рассчитанных по
+// parameters, без рёбер closed_edges. Рабочие буферы выделяются один раз на
+// поток
+template <typename Weight>
+std::optional<typename BaseRouter<Weight>::RouteInfo> BuildShortestRoute(
+  const DirectedWeightedGraph<Weight> &graph, VertexId from, VertexId to,
+  const WeightParameters &parameters, const ClosedEdges &closed_edges = {});
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+  : graph_(graph)
+{
+  for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+    graph.ForEachIncidentEdge(vertex, [](EdgeId, const Edge<Weight> &edge) {
+      if (edge.weight < ZERO_WEIGHT) {
+        throw std::domain_error("Edges' weights should be non-negative");
+      }
+    });
+  }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+  return BuildShortestRoute(graph_, from, to, graph_.GetWeightParameters());
+}
+
+template <typename Weight>
+std::optional<typename BaseRouter<Weight>::RouteInfo> BuildShortestRoute(
+  const DirectedWeightedGraph<Weight> &graph, VertexId from, VertexId to,
+  const WeightParameters &parameters, const ClosedEdges &closed_edges) {
+  using SearchState = detail::SearchState<Weight>;
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+  const size_t vertex_count = graph.GetVertexCount();
+  if (from >= vertex_count || to >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  static thread_local SearchState thread_state;
+  SearchState &state = thread_state;
+  state.Reset(vertex_count);
+  state.Reach(from, Weight{}, SearchState::NO_EDGE);
+
+  while (const auto item = state.Pop()) {
+    const auto [weight, vertex] = *item;
+    if (vertex == to) {
+      break;
+    }
+
+    graph.ForEachIncidentEdge(vertex,
+      [&state, &closed_edges, weight = weight](EdgeId edge_id,
+        const Edge<Weight> &edge) {
+        if (closed_edges.IsClosed(edge_id)) {
+          return;
+        }
+        const Weight candidate_weight = weight + edge.weight;
+        if (!state.IsReached(edge.to)
+          || candidate_weight < state.weights[edge.to]) {
+          state.Reach(edge.to, candidate_weight, edge_id);
+        }
+      }, parameters);
+  }
+
+  if (!state.IsReached(to)) {
+    return std::nullopt;
+  }
+
+  std::vector<EdgeId> edges;
+  for (EdgeId edge_id = state.prev_edges[to]; edge_id != SearchState::NO_EDGE;
+    edge_id = state.prev_edges[graph.GetEdge(edge_id).from]) {
+    edges.push_back(edge_id);
+  }
+  std::reverse(edges.begin(), edges.end());
+
+  return RouteInfo{state.weights[to], std::move(edges)};
+}
+
+// Веса кратчайших путей из from до каждой из вершин targets при весах рёбер,
+// рассчитанных по parameters, без рёбер closed_edges, найденные одним поиском
+// Дейкстры. Поиск останавливается, как только извлечены все цели. Рабочие
+// буферы выделяются один раз на поток, поэтому функцию можно вызывать
+// параллельно для разных начальных вершин
+template <typename Weight>
+std::vector<std::optional<Weight>> BuildRouteWeights(
+  const DirectedWeightedGraph<Weight> &graph, VertexId from,
+  const std::vector<VertexId> &targets, const WeightParameters &parameters,
+  const ClosedEdges &closed_edges = {}) {
+  using SearchState = detail::SearchState<Weight>;
+
+  const size_t vertex_count = graph.GetVertexCount();
+  if (from >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  // Целевые вершины отмечаются в отдельном наборе меток
+  static thread_local SearchState thread_states[2];
+  SearchState &state = thread_states[0];
+  SearchState &targets_state = thread_states[1];
+  targets_state.Reset(vertex_count);
+  size_t targets_left = 0;
+  for (const VertexId target : targets) {
+    if (target >= vertex_count) {
+      throw std::out_of_range("Vertex id is out of range");
+    }
+    if (!targets_state.IsReached(target)) {
+      targets_state.Label(target, Weight{}, SearchState::NO_EDGE);
+      ++targets_left;
+    }
+  }
+
+  state.Reset(vertex_count);
+  state.Reach(from, Weight{}, SearchState::NO_EDGE);
+
+  while (targets_left > 0) {
+    const auto item = state.Pop();
+    if (!item) {
+      break;
+    }
+
+    const auto [weight, vertex] = *item;
+    if (targets_state.IsReached(vertex)) {
+      --targets_left;
+    }
+
+    graph.ForEachIncidentEdge(vertex,
+      [&state, &closed_edges, weight = weight](EdgeId edge_id,
+        const Edge<Weight> &edge) {
+        if (closed_edges.IsClosed(edge_id)) {
+          return;
+        }
+        const Weight candidate_weight = weight + edge.weight;
+        if (!state.IsReached(edge.to)
+          || candidate_weight < state.weights[edge.to]) {
+          state.Reach(edge.to, candidate_weight, edge_id);
+        }
+      }, parameters);
+  }
+
+  std::vector<std::optional<Weight>> weights;
+  weights.reserve(targets.size());
+  for (const VertexId target : targets) {
+    weights.push_back(state.IsReached(target)
+      ? std::make_optional(state.weights[target]) : std::nullopt);
+  }
+  return weights;
+}
+
+// Вершины, достижимые из from с весом пути не больше max_weight при весах
+// рёбер, рассчитанных по parameters, без рёбер closed_edges, вместе с весами
+// путей в порядке их возрастания. Поиск Дейкстры прекращается, как только из
+// кучи извлекается вершина с весом больше max_weight
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> BuildReachableVertices(
+  const DirectedWeightedGraph<Weight> &graph, VertexId from,
+  Weight max_weight, const WeightParameters &parameters,
+  const ClosedEdges &closed_edges = {}) {
+  using SearchState = detail::SearchState<Weight>;
+
+  const size_t vertex_count = graph.GetVertexCount();
+  if (from >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  static thread_local SearchState thread_state;
+  SearchState &state = thread_state;
+  state.Reset(vertex_count);
+  state.Reach(from, Weight{}, SearchState::NO_EDGE);
+
+  std::vector<std::pair<VertexId, Weight>> reachable;
+  while (const auto item = state.Pop()) {
+    const auto [weight, vertex] = *item;
+    if (max_weight < weight) {
+      break;
+    }
+    reachable.emplace_back(vertex, weight);
+
+    graph.ForEachIncidentEdge(vertex,
+      [&state, &closed_edges, max_weight, weight = weight](EdgeId edge_id,
+        const Edge<Weight> &edge) {
+        if (closed_edges.IsClosed(edge_id)) {
+          return;
+        }
+        const Weight candidate_weight = weight + edge.weight;
+        if (!(max_weight < candidate_weight) && (!state.IsReached(edge.to)
+          || candidate_weight < state.weights[edge.to])) {
+          state.Reach(edge.to, candidate_weight, edge_id);
+        }
+      }, parameters);
+  }
+  return reachable;
+}
+
+}  // namespace graph
@@ -1,34 +1,41 @@
 #pragma once
 
+#include <cstdint>
 #include <set>
 #include <string>
 #include <vector>
 
 namespace tc {
 
+// Остановки и автобусы нумеруются подряд в порядке добавления в справочник,
+// номер служит индексом в его массивах
+using StopId = uint32_t;
+using BusId = uint32_t;
+
 struct Stop {
   Stop() = default;
 
-  Stop(std::string stop_name, double latitude, double longitude);
+  Stop(std::string stop_name, StopId stop_id);
 
   std::string name;
-  double lat{};
-  double lng{};
+  StopId id{};
 };
 
-using Route = std::vector<Stop *>;
-
 struct Bus {
   Bus() = default;
 
-  Bus(std::string bus_name, std::vector<Stop *> bus_stops,
-    std::vector<Stop *> final_stops);
+  Bus(std::string bus_name, BusId bus_id, bool is_roundtrip,
+    size_t route_offset, size_t route_size, std::vector<StopId> final_stops);
 
-  bool operator<(Bus &other);
+  bool operator<(const Bus &other) const;
 
   std::string name;
-  Route stops;
-  Route final_stops;
+  BusId id{};
+  bool is_roundtrip{};
+  // Положение маршрута в общем массиве остановок маршрутов справочника
+  size_t route_offset{};
+  size_t route_size{};
+  std::vector<StopId> final_stops;
 };
 
 struct BusInfo {
@@ -39,16 +46,12 @@ struct BusInfo {
 };
 
 struct BusPtrComparator {
-  bool operator()(Bus *lhs, Bus *rhs) const;
+  bool operator()(const Bus *lhs, const Bus *rhs) const;
 };
 
-using Buses = std::set<Bus *, BusPtrComparator>;
+using Buses = std::set<const Bus *, BusPtrComparator>;
 
 struct Hasher {
-  static const size_t salt = 77;
-  static size_t CountStopHash(const Stop *stop);
-  static size_t CountRouteHash(const Route *route);
-  size_t operator()(const std::pair<Stop *, Stop *> &stops) const;
   size_t operator()(const Bus *bus) const;
   size_t operator()(const Stop *stop) const;
 };
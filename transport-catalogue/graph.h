@@ -2,7 +2,15 @@
 
 #include "ranges.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <iterator>
+#include <optional>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -17,75 +25,741 @@ struct Edge {
   Weight weight;
 };
 
+// Линия порождает неявные рёбра без их хранения: для каждой пары позиций
+// i < j существует ребро from[i] -> to[j] весом (lengths[j] - lengths[i]),
+// делённым на скорость линий графа. Так автобусный маршрут из n остановок
+// занимает O(n) памяти вместо O(n^2) рёбер
+struct EdgeLine {
+  std::vector<VertexId> from;
+  std::vector<VertexId> to;
+  std::vector<uint64_t> lengths;  // Длина линии от начала до позиции
+
+  size_t GetSize() const {
+    return lengths.size();
+  }
+};
+
+// Положение неявного ребра: линия и позиции его начала и конца
+struct LineEdge {
+  size_t line;
+  size_t begin;
+  size_t end;
+};
+
+// Позиция линии, с которой начинаются неявные рёбра вершины
+struct LineStop {
+  size_t line;
+  size_t position;
+};
+
+// Параметры, от которых зависят веса рёбер: вес явного ребра равен
+// хранимому весу, умноженному на explicit_weight_scale, вес ребра линии -
+// разности длин, делённой на line_speed. Веса можно пересчитать с другими
+// параметрами без перестроения графа
+struct WeightParameters {
+  double line_speed = 1.0;
+  double explicit_weight_scale = 1.0;
+
+  bool operator==(const WeightParameters &other) const {
+    return line_speed == other.line_speed
+      && explicit_weight_scale == other.explicit_weight_scale;
+  }
+  bool operator!=(const WeightParameters &other) const {
+    return !(*this == other);
+  }
+};
+
+// Положение линии внутри другой линии: позиция offset линии line
+// соответствует первой позиции вложенной линии
+struct LineWindow {
+  size_t line;
+  size_t offset;
+};
+
+// Находит линии, неявные рёбра которых повторяют рёбра другой линии: её
+// вершины и длины отрезков встречаются в другой линии подряд. Каждое ребро
+// такой линии совпадает по концам и весу с ребром покрывающей линии, поэтому
+// линию можно не добавлять в граф. Для каждой линии возвращается окно в
+// сохраняемой линии, которая её покрывает, или nullopt, если линия
+// сохраняется. Из одинаковых линий сохраняется первая
+inline std::vector<std::optional<LineWindow>> FindCoveredLines(
+  const std::vector<EdgeLine> &lines) {
+  // Линии просматриваются от длинных к коротким, поэтому покрывающая линия
+  // уже просмотрена. Покрытие транзитивно, и достаточно искать окно только в
+  // сохраняемых линиях
+  std::vector<size_t> order(lines.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(), [&lines](size_t lhs, size_t rhs) {
+    return lines[lhs].GetSize() > lines[rhs].GetSize();
+  });
+
+  auto covers = [&lines](const LineWindow &window, const EdgeLine &line) {
+    const auto &outer = lines[window.line];
+    if (window.offset + line.GetSize() > outer.GetSize()) {
+      return false;
+    }
+    for (size_t position = 0; position < line.GetSize(); ++position) {
+      const size_t outer_position = window.offset + position;
+      if (outer.from[outer_position] != line.from[position]
+        || outer.to[outer_position] != line.to[position]
+        || outer.lengths[outer_position] - outer.lengths[window.offset]
+          != line.lengths[position] - line.lengths[0]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<std::optional<LineWindow>> covered(lines.size());
+  std::unordered_map<VertexId, std::vector<LineWindow>> kept_positions;
+  for (const size_t line_id : order) {
+    const auto &line = lines[line_id];
+    if (line.GetSize() == 0) {
+      continue;
+    }
+
+    if (const auto it = kept_positions.find(line.from[0]);
+      it != kept_positions.end()) {
+      for (const auto &window : it->second) {
+        if (covers(window, line)) {
+          covered[line_id] = window;
+          break;
+        }
+      }
+    }
+
+    if (!covered[line_id]) {
+      for (size_t position = 0; position < line.GetSize(); ++position) {
+        kept_positions[line.from[position]].push_back({line_id, position});
+      }
+    }
+  }
+  return covered;
+}
+
+namespace detail {
+
+// Раскладывает элементы по вершинам в формате CSR (compressed sparse row):
+// элементы вершины v занимают [offsets[v], offsets[v + 1]) общего массива.
+// Порядок элементов одной вершины сохраняется
+template <typename Item, typename GetVertex>
+std::vector<size_t> BuildCsrOffsets(const std::vector<Item> &items,
+  size_t vertex_count, GetVertex get_vertex, std::vector<size_t> &order) {
+  std::vector<size_t> offsets(vertex_count + 1, 0);
+  for (const auto &item : items) {
+    ++offsets.at(get_vertex(item) + 1);
+  }
+  for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+    offsets[vertex + 1] += offsets[vertex];
+  }
+
+  std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+  order.resize(items.size());
+  for (size_t index = 0; index < items.size(); ++index) {
+    order[positions[get_vertex(items[index])]++] = index;
+  }
+  return offsets;
+}
+
+}  // namespace detail
+
+// Граф строится в два этапа: сначала добавляются явные рёбра и линии, затем
+// вызов Freeze переводит его в неизменяемое представление CSR. Исходящие
+// рёбра всех вершин лежат в общих массивах концов и весов подряд по
+// вершинам, позиции линий - в общем массиве по вершинам. Перебор рёбер и
+// маршрутизаторы работают только с замороженным графом
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-  using IncidenceList = std::vector<EdgeId>;
-  using IncidentEdgesRange =
-  ranges::Range<typename IncidenceList::const_iterator>;
+  using LineStopIterator = std::vector<LineStop>::const_iterator;
 
 public:
+  using LineStopsRange = ranges::Range<LineStopIterator>;
+
+  // Перебирает сначала явные рёбра вершины, затем неявные рёбра линий
+  class IncidentEdgeIterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = EdgeId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const EdgeId *;
+    using reference = EdgeId;
+
+    IncidentEdgeIterator(const DirectedWeightedGraph *graph,
+      EdgeId explicit_it, EdgeId explicit_end, LineStopIterator stop_it,
+      LineStopIterator stop_end);
+
+    EdgeId operator*() const;
+    IncidentEdgeIterator &operator++();
+    IncidentEdgeIterator operator++(int);
+    bool operator==(const IncidentEdgeIterator &other) const;
+    bool operator!=(const IncidentEdgeIterator &other) const;
+
+  private:
+    void SkipExhaustedStops();
+
+    const DirectedWeightedGraph *graph_;
+    EdgeId explicit_it_;
+    EdgeId explicit_end_;
+    LineStopIterator stop_it_;
+    LineStopIterator stop_end_;
+    size_t end_position_ = 0;
+  };
+
+  using IncidentEdgesRange = ranges::Range<IncidentEdgeIterator>;
+
   DirectedWeightedGraph() = default;
   explicit DirectedWeightedGraph(size_t vertex_count);
   EdgeId AddEdge(const Edge<Weight>& edge);
 
+  // Добавляет линию неявных рёбер. Рёбра линий нумеруются после явных рёбер,
+  // поэтому явные рёбра должны быть добавлены раньше линий
+  size_t AddLine(EdgeLine line);
+
+  // Строит представление CSR. Явные рёбра упорядочиваются по началу, поэтому
+  // их номера могут измениться: возвращаются прежние номера рёбер в новом
+  // порядке. Рёбра, добавленные по порядку начальных вершин, сохраняют номера
+  std::vector<EdgeId> Freeze();
+  bool IsFrozen() const;
+
   size_t GetVertexCount() const;
   size_t GetEdgeCount() const;
-  const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+  size_t GetExplicitEdgeCount() const;
+  Edge<Weight> GetEdge(EdgeId edge_id) const;
+  Edge<Weight> GetEdge(EdgeId edge_id,
+    const WeightParameters &parameters) const;
   IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
-  std::vector<Edge<Weight>> &GetEdges();
-  std::vector<IncidenceList> &GetIncidenceList();
+  // Вызывает visitor(edge_id, edge) для каждого явного ребра, исходящего из
+  // вершины
+  template <typename Visitor>
+  void ForEachExplicitEdge(VertexId vertex, Visitor visitor) const;
+  template <typename Visitor>
+  void ForEachExplicitEdge(VertexId vertex, Visitor visitor,
+    const WeightParameters &parameters) const;
+
+  // Вызывает visitor(edge_id, edge) для каждого ребра, исходящего из вершины,
+  // в том же порядке, что и GetIncidentEdges. Рёбра линий вычисляются подряд,
+  // без поиска линии по номеру ребра, как в GetEdge
+  template <typename Visitor>
+  void ForEachIncidentEdge(VertexId vertex, Visitor visitor) const;
+  template <typename Visitor>
+  void ForEachIncidentEdge(VertexId vertex, Visitor visitor,
+    const WeightParameters &parameters) const;
+
+  // Возвращает положение ребра в линии, если ребро неявное
+  std::optional<LineEdge> GetLineEdge(EdgeId edge_id) const;
+  EdgeId GetLineEdgeId(size_t line, size_t begin, size_t end) const;
+  Weight GetLineEdgeWeight(size_t line, size_t begin, size_t end) const;
+  Weight GetLineEdgeWeight(size_t line, size_t begin, size_t end,
+    const WeightParameters &parameters) const;
+
+  // Позиции линий, на которых вершина является началом неявных рёбер, в
+  // порядке добавления линий
+  LineStopsRange GetLineStops(VertexId vertex) const;
+
+  // Параметры весов, с которыми перебираются рёбра графа
+  const WeightParameters &GetWeightParameters() const;
+  void SetWeightParameters(const WeightParameters &parameters);
+
+  // Массивы CSR явных рёбер: рёбра вершины v имеют номера
+  // [offsets[v], offsets[v + 1]), концы и хранимые веса без множителя
+  // хранятся по номерам рёбер
+  const std::vector<EdgeId> &GetEdgeOffsets() const;
+  const std::vector<VertexId> &GetEdgeTargets() const;
+  const std::vector<Weight> &GetEdgeWeights() const;
+  const std::vector<EdgeLine> &GetLines() const;
+
+  // Объём памяти, занимаемый массивами CSR и линиями, в байтах
+  size_t GetMemoryUsage() const;
 
 private:
-  std::vector<Edge<Weight>> edges_;
-  std::vector<IncidenceList> incidence_lists_;
+  VertexId GetEdgeSource(EdgeId edge_id) const;
+
+  size_t vertex_count_ = 0;
+  size_t explicit_edge_count_ = 0;
+  bool is_frozen_ = false;
+
+  // Рёбра и позиции линий до построения CSR
+  std::vector<Edge<Weight>> pending_edges_;
+  std::vector<LineStop> pending_line_stops_;
+  std::vector<VertexId> pending_line_stop_vertices_;
+
+  std::vector<EdgeId> edge_offsets_;
+  std::vector<VertexId> edge_targets_;
+  std::vector<Weight> edge_weights_;
+  std::vector<size_t> line_stop_offsets_;
+  std::vector<LineStop> line_stops_;
+
+  std::vector<EdgeLine> lines_;
+  std::vector<size_t> line_edge_offsets_{0};
+  WeightParameters weight_parameters_;
 };
 
+template <typename Weight>
+DirectedWeightedGraph<Weight>::IncidentEdgeIterator::IncidentEdgeIterator(
+  const DirectedWeightedGraph *graph, EdgeId explicit_it, EdgeId explicit_end,
+  LineStopIterator stop_it, LineStopIterator stop_end)
+  : graph_(graph)
+  , explicit_it_(explicit_it)
+  , explicit_end_(explicit_end)
+  , stop_it_(stop_it)
+  , stop_end_(stop_end) {
+  if (stop_it_ != stop_end_) {
+    end_position_ = stop_it_->position + 1;
+  }
+  SkipExhaustedStops();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::IncidentEdgeIterator::SkipExhaustedStops() {
+  while (stop_it_ != stop_end_
+    && end_position_ >= graph_->lines_[stop_it_->line].GetSize()) {
+    ++stop_it_;
+    end_position_ = stop_it_ != stop_end_ ? stop_it_->position + 1 : 0;
+  }
+}
+
+template <typename Weight>
+EdgeId DirectedWeightedGraph<Weight>::IncidentEdgeIterator::operator*() const {
+  if (explicit_it_ != explicit_end_) {
+    return explicit_it_;
+  }
+  return graph_->GetLineEdgeId(stop_it_->line, stop_it_->position,
+    end_position_);
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgeIterator &
+DirectedWeightedGraph<Weight>::IncidentEdgeIterator::operator++() {
+  if (explicit_it_ != explicit_end_) {
+    ++explicit_it_;
+  } else {
+    ++end_position_;
+    SkipExhaustedStops();
+  }
+  return *this;
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgeIterator
+DirectedWeightedGraph<Weight>::IncidentEdgeIterator::operator++(int) {
+  auto copy = *this;
+  ++*this;
+  return copy;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IncidentEdgeIterator::operator==(
+  const IncidentEdgeIterator &other) const {
+  return explicit_it_ == other.explicit_it_ && stop_it_ == other.stop_it_
+    && end_position_ == other.end_position_;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IncidentEdgeIterator::operator!=(
+  const IncidentEdgeIterator &other) const {
+  return !(*this == other);
+}
+
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-  : incidence_lists_(vertex_count) {
+  : vertex_count_(vertex_count) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-  edges_.push_back(edge);
-  const EdgeId id = edges_.size() - 1;
-  incidence_lists_.at(edge.from).push_back(id);
-  return id;
+  if (is_frozen_) {
+    throw std::logic_error("Graph is frozen");
+  }
+  if (!lines_.empty()) {
+    throw std::logic_error("Edges should be added before lines");
+  }
+  if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+    throw std::out_of_range("Edge vertex is out of range");
+  }
+  pending_edges_.push_back(edge);
+  return explicit_edge_count_++;
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::AddLine(EdgeLine line) {
+  if (is_frozen_) {
+    throw std::logic_error("Graph is frozen");
+  }
+  const size_t size = line.GetSize();
+  if (line.from.size() != size || line.to.size() != size) {
+    throw std::invalid_argument("Line vertices don't match its lengths");
+  }
+  for (size_t position = 0; position < size; ++position) {
+    if (line.from[position] >= vertex_count_
+      || line.to[position] >= vertex_count_) {
+      throw std::out_of_range("Line vertex is out of range");
+    }
+  }
+
+  // Позиции линий должны следовать по порядку для каждой вершины, чтобы
+  // рёбра перебирались в порядке их номеров
+  const size_t line_id = lines_.size();
+  for (size_t position = 0; position + 1 < size; ++position) {
+    pending_line_stops_.push_back({line_id, position});
+    pending_line_stop_vertices_.push_back(line.from[position]);
+  }
+
+  line_edge_offsets_.push_back(line_edge_offsets_.back()
+    + (size > 1 ? size * (size - 1) / 2 : 0));
+  lines_.push_back(std::move(line));
+  return line_id;
+}
+
+template <typename Weight>
+std::vector<EdgeId> DirectedWeightedGraph<Weight>::Freeze() {
+  if (is_frozen_) {
+    throw std::logic_error("Graph is already frozen");
+  }
+
+  std::vector<EdgeId> edge_order;
+  edge_offsets_ = detail::BuildCsrOffsets(pending_edges_, vertex_count_,
+    [](const Edge<Weight> &edge) { return edge.from; }, edge_order);
+  edge_targets_.reserve(edge_order.size());
+  edge_weights_.reserve(edge_order.size());
+  for (const EdgeId edge_id : edge_order) {
+    edge_targets_.push_back(pending_edges_[edge_id].to);
+    edge_weights_.push_back(pending_edges_[edge_id].weight);
+  }
+
+  std::vector<size_t> stop_order;
+  line_stop_offsets_ = detail::BuildCsrOffsets(pending_line_stop_vertices_,
+    vertex_count_, [](VertexId vertex) { return vertex; }, stop_order);
+  line_stops_.reserve(stop_order.size());
+  for (const size_t index : stop_order) {
+    line_stops_.push_back(pending_line_stops_[index]);
+  }
+
+  pending_edges_ = {};
+  pending_line_stops_ = {};
+  pending_line_stop_vertices_ = {};
+  is_frozen_ = true;
+  return edge_order;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+  return is_frozen_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-  return incidence_lists_.size();
+  return vertex_count_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-  return edges_.size();
+  return explicit_edge_count_ + line_edge_offsets_.back();
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetExplicitEdgeCount() const {
+  return explicit_edge_count_;
 }
 
+// Рёбра линии из n позиций нумеруются по строкам треугольной матрицы: сначала
+// все рёбра из позиции 0, затем из позиции 1 и т. д.
 template <typename Weight>
-const Edge<Weight> &
-DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-  return edges_.at(edge_id);
+EdgeId DirectedWeightedGraph<Weight>::GetLineEdgeId(size_t line, size_t begin,
+  size_t end) const {
+  const size_t size = lines_[line].GetSize();
+  return explicit_edge_count_ + line_edge_offsets_[line]
+    + begin * (2 * size - begin - 1) / 2 + (end - begin - 1);
+}
+
+template <typename Weight>
+Weight DirectedWeightedGraph<Weight>::GetLineEdgeWeight(size_t line,
+  size_t begin, size_t end) const {
+  return GetLineEdgeWeight(line, begin, end, weight_parameters_);
+}
+
+template <typename Weight>
+Weight DirectedWeightedGraph<Weight>::GetLineEdgeWeight(size_t line,
+  size_t begin, size_t end, const WeightParameters &parameters) const {
+  const auto &lengths = lines_[line].lengths;
+  return Weight(static_cast<double>(lengths[end] - lengths[begin])
+    / parameters.line_speed);
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::LineStopsRange
+DirectedWeightedGraph<Weight>::GetLineStops(VertexId vertex) const {
+  if (vertex + 1 >= line_stop_offsets_.size()) {
+    return {line_stops_.end(), line_stops_.end()};
+  }
+  return {line_stops_.begin() + line_stop_offsets_[vertex],
+    line_stops_.begin() + line_stop_offsets_[vertex + 1]};
+}
+
+template <typename Weight>
+std::optional<LineEdge>
+DirectedWeightedGraph<Weight>::GetLineEdge(EdgeId edge_id) const {
+  if (edge_id < explicit_edge_count_) {
+    return std::nullopt;
+  }
+  if (edge_id >= GetEdgeCount()) {
+    throw std::out_of_range("Edge id is out of range");
+  }
+
+  const size_t line_edge_id = edge_id - explicit_edge_count_;
+  const size_t line = static_cast<size_t>(std::upper_bound(
+    line_edge_offsets_.begin(), line_edge_offsets_.end(), line_edge_id)
+    - line_edge_offsets_.begin()) - 1;
+  const size_t local_id = line_edge_id - line_edge_offsets_[line];
+  const size_t size = lines_[line].GetSize();
+
+  // Поиск строки треугольной матрицы, в которую попадает ребро
+  size_t low = 0;
+  size_t high = size - 1;
+  while (high - low > 1) {
+    const size_t middle = (low + high) / 2;
+    if (middle * (2 * size - middle - 1) / 2 <= local_id) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  const size_t begin = low;
+  const size_t end =
+    begin + 1 + local_id - begin * (2 * size - begin - 1) / 2;
+  return LineEdge{line, begin, end};
+}
+
+// Начало явного ребра - последняя вершина, рёбра которой начинаются не
+// позже его номера
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeSource(EdgeId edge_id) const {
+  return static_cast<VertexId>(std::upper_bound(edge_offsets_.begin(),
+    edge_offsets_.end(), edge_id) - edge_offsets_.begin()) - 1;
+}
+
+template <typename Weight>
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+  return GetEdge(edge_id, weight_parameters_);
+}
+
+template <typename Weight>
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id,
+  const WeightParameters &parameters) const {
+  if (edge_id < explicit_edge_count_) {
+    return {
+      GetEdgeSource(edge_id),
+      edge_targets_.at(edge_id),
+      edge_weights_[edge_id] * parameters.explicit_weight_scale
+    };
+  }
+
+  const auto line_edge = *GetLineEdge(edge_id);
+  const auto &line = lines_[line_edge.line];
+  return {
+    line.from[line_edge.begin],
+    line.to[line_edge.end],
+    GetLineEdgeWeight(line_edge.line, line_edge.begin, line_edge.end,
+      parameters)
+  };
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-  return ranges::AsRange(incidence_lists_.at(vertex));
+  const EdgeId edges_begin = edge_offsets_.at(vertex);
+  const EdgeId edges_end = edge_offsets_.at(vertex + 1);
+  const auto line_stops = GetLineStops(vertex);
+
+  return {
+    IncidentEdgeIterator(this, edges_begin, edges_end, line_stops.begin(),
+      line_stops.end()),
+    IncidentEdgeIterator(this, edges_end, edges_end, line_stops.end(),
+      line_stops.end())
+  };
+}
+
+template <typename Weight>
+template <typename Visitor>
+void DirectedWeightedGraph<Weight>::ForEachExplicitEdge(VertexId vertex,
+  Visitor visitor) const {
+  ForEachExplicitEdge(vertex, visitor, weight_parameters_);
+}
+
+template <typename Weight>
+template <typename Visitor>
+void DirectedWeightedGraph<Weight>::ForEachExplicitEdge(VertexId vertex,
+  Visitor visitor, const WeightParameters &parameters) const {
+  const EdgeId edges_end = edge_offsets_.at(vertex + 1);
+  for (EdgeId edge_id = edge_offsets_[vertex]; edge_id < edges_end;
+    ++edge_id) {
+    visitor(edge_id, Edge<Weight>{
+      vertex,
+      edge_targets_[edge_id],
+      edge_weights_[edge_id] * parameters.explicit_weight_scale
+    });
+  }
 }
 
 template <typename Weight>
-std::vector<Edge<Weight>> &DirectedWeightedGraph<Weight>::GetEdges() {
-  return edges_;
+template <typename Visitor>
+void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex,
+  Visitor visitor) const {
+  ForEachIncidentEdge(vertex, visitor, weight_parameters_);
 }
 
 template <typename Weight>
-std::vector<std::vector<EdgeId>> &
-DirectedWeightedGraph<Weight>::GetIncidenceList() {
-  return incidence_lists_;
+template <typename Visitor>
+void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex,
+  Visitor visitor, const WeightParameters &parameters) const {
+  ForEachExplicitEdge(vertex, visitor, parameters);
+  for (const auto [line_id, begin] : GetLineStops(vertex)) {
+    const auto &line = lines_[line_id];
+    EdgeId edge_id = GetLineEdgeId(line_id, begin, begin + 1);
+    for (size_t end = begin + 1; end < line.GetSize(); ++end, ++edge_id) {
+      visitor(edge_id, Edge<Weight>{
+        line.from[begin],
+        line.to[end],
+        GetLineEdgeWeight(line_id, begin, end, parameters)
+      });
+    }
+  }
+}
+
+template <typename Weight>
+const WeightParameters &
+DirectedWeightedGraph<Weight>::GetWeightParameters() const {
+  return weight_parameters_;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetWeightParameters(
+  const WeightParameters &parameters) {
+  weight_parameters_ = parameters;
+}
+
+template <typename Weight>
+const std::vector<EdgeId> &
+DirectedWeightedGraph<Weight>::GetEdgeOffsets() const {
+  return edge_offsets_;
+}
+
+template <typename Weight>
+const std::vector<VertexId> &
+DirectedWeightedGraph<Weight>::GetEdgeTargets() const {
+  return edge_targets_;
+}
+
+template <typename Weight>
+const std::vector<Weight> &
+DirectedWeightedGraph<Weight>::GetEdgeWeights() const {
+  return edge_weights_;
+}
+
+template <typename Weight>
+const std::vector<EdgeLine> &DirectedWeightedGraph<Weight>::GetLines() const {
+  return lines_;
+}
+
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetMemoryUsage() const {
+  size_t memory = sizeof(EdgeId) * edge_offsets_.size()
+    + sizeof(VertexId) * edge_targets_.size()
+    + sizeof(Weight) * edge_weights_.size()
+    + sizeof(size_t) * line_stop_offsets_.size()
+    + sizeof(LineStop) * line_stops_.size()
+    + sizeof(size_t) * line_edge_offsets_.size();
+  for (const auto &line : lines_) {
+    memory += sizeof(VertexId) * (line.from.size() + line.to.size())
+      + sizeof(uint64_t) * line.lengths.size();
+  }
+  return memory;
+}
+
+// Списки входящих рёбер графа для обратных поисков в формате CSR: явные
+// рёбра и позиции линий, на которых вершина является концом
+// неявных рёбер. Строятся по замороженному графу
+template <typename Weight>
+class IncomingEdges {
+public:
+  explicit IncomingEdges(const DirectedWeightedGraph<Weight> &graph);
+
+  // Вызывает visitor(edge_id, edge) для каждого ребра, входящего в вершину
+  template <typename Visitor>
+  void ForEach(VertexId vertex, Visitor visitor) const;
+
+private:
+  const DirectedWeightedGraph<Weight> &graph_;
+  std::vector<size_t> edge_offsets_;
+  std::vector<EdgeId> edge_ids_;
+  std::vector<VertexId> edge_sources_;
+  std::vector<size_t> line_stop_offsets_;
+  std::vector<LineStop> line_stops_;
+};
+
+template <typename Weight>
+IncomingEdges<Weight>::IncomingEdges(const DirectedWeightedGraph<Weight> &graph)
+  : graph_(graph) {
+  const size_t vertex_count = graph.GetVertexCount();
+  edge_offsets_ = detail::BuildCsrOffsets(graph.GetEdgeTargets(),
+    vertex_count, [](VertexId vertex) { return vertex; }, edge_ids_);
+  edge_sources_.resize(edge_ids_.size());
+  const auto &edge_offsets = graph.GetEdgeOffsets();
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    std::fill(edge_sources_.begin() + edge_offsets[vertex],
+      edge_sources_.begin() + edge_offsets[vertex + 1], vertex);
+  }
+
+  std::vector<LineStop> line_stops;
+  std::vector<VertexId> line_stop_vertices;
+  const auto &lines = graph.GetLines();
+  for (size_t line_id = 0; line_id < lines.size(); ++line_id) {
+    for (size_t position = 1; position < lines[line_id].GetSize();
+      ++position) {
+      line_stops.push_back({line_id, position});
+      line_stop_vertices.push_back(lines[line_id].to[position]);
+    }
+  }
+
+  std::vector<size_t> stop_order;
+  line_stop_offsets_ = detail::BuildCsrOffsets(line_stop_vertices,
+    vertex_count, [](VertexId vertex) { return vertex; }, stop_order);
+  line_stops_.reserve(stop_order.size());
+  for (const size_t index : stop_order) {
+    line_stops_.push_back(line_stops[index]);
+  }
+}
+
+template <typename Weight>
+template <typename Visitor>
+void IncomingEdges<Weight>::ForEach(VertexId vertex, Visitor visitor) const {
+  const auto &edge_weights = graph_.GetEdgeWeights();
+  const double explicit_weight_scale =
+    graph_.GetWeightParameters().explicit_weight_scale;
+  for (size_t index = edge_offsets_.at(vertex);
+    index < edge_offsets_[vertex + 1]; ++index) {
+    const EdgeId edge_id = edge_ids_[index];
+    visitor(edge_id, Edge<Weight>{
+      edge_sources_[edge_id],
+      vertex,
+      edge_weights[edge_id] * explicit_weight_scale
+    });
+  }
+
+  const auto &lines = graph_.GetLines();
+  for (size_t index = line_stop_offsets_[vertex];
+    index < line_stop_offsets_[vertex + 1]; ++index) {
+    const auto [line_id, end] = line_stops_[index];
+    const auto &line = lines[line_id];
+    for (size_t begin = 0; begin < end; ++begin) {
+      visitor(graph_.GetLineEdgeId(line_id, begin, end), Edge<Weight>{
+        line.from[begin],
+        line.to[end],
+        graph_.GetLineEdgeWeight(line_id, begin, end)
+      });
+    }
+  }
 }
 
 }  // namespace graph
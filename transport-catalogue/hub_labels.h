@@ -0,0 +1,314 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Метки хабов (hub labeling) для ответа на запрос веса кратчайшего пути без
+// поиска по графу. Каждая вершина v хранит исходящую метку - хабы h с
+// весами d(v, h) - и входящую метку - хабы h с весами d(h, v). Метки
+// строятся так, что для любой пары вершин кратчайший путь проходит через
+// общий хаб исходящей метки начала и входящей метки конца, поэтому
+//   d(u, v) = min(d(u, h) + d(h, v)) по общим хабам h.
+// Хабы меток хранятся по возрастанию номеров, и минимум находится слиянием
+// двух отсортированных массивов. Сами пути метки не восстанавливают
+template <typename Weight>
+class HubLabels {
+public:
+  // Метки хранятся в формате CSR: метка вершины v занимает
+  // [offsets[v], offsets[v + 1]) массивов хабов и весов. Хабы задаются
+  // номерами в порядке построения меток
+  struct HubLabelsData {
+    std::vector<size_t> out_offsets;
+    std::vector<VertexId> out_hubs;
+    std::vector<Weight> out_weights;  // d(v, h)
+    std::vector<size_t> in_offsets;
+    std::vector<VertexId> in_hubs;
+    std::vector<Weight> in_weights;   // d(h, v)
+  };
+
+  explicit HubLabels(const DirectedWeightedGraph<Weight> &graph);
+
+  // Восстанавливает метки по ранее рассчитанным данным
+  HubLabels(const DirectedWeightedGraph<Weight> &graph, HubLabelsData data);
+
+  // Вес кратчайшего пути из from в to или nullopt, если пути нет
+  std::optional<Weight> GetDistance(VertexId from, VertexId to) const;
+
+  const HubLabelsData &GetHubLabelsData() const;
+
+  // Средний и наибольший размер метки вершины по обоим направлениям
+  double GetAverageLabelSize() const;
+  size_t GetMaxLabelSize() const;
+
+  // Объём памяти, занимаемый метками, в байтах
+  size_t GetMemoryUsage() const;
+
+private:
+  using Label = std::vector<std::pair<VertexId, Weight>>;
+
+  // Поиск Дейкстры из root, добавляющий хаб rank в метки labels достигнутых
+  // вершин. Вершина не получает хаб и не раскрывается, если уже построенные
+  // метки дают путь не длиннее: root_label - метка root, по которой
+  // проверяется путь
+  template <typename ForEachEdge>
+  static void AddHub(size_t vertex_count, VertexId root, VertexId rank,
+    const Label &root_label, std::vector<Label> &labels,
+    ForEachEdge for_each_edge);
+
+  // Порядок вершин, в котором они становятся хабами
+  static std::vector<VertexId> GetVertexOrder(
+    const DirectedWeightedGraph<Weight> &graph);
+
+  static void FlattenLabels(const std::vector<Label> &labels,
+    std::vector<size_t> &offsets, std::vector<VertexId> &hubs,
+    std::vector<Weight> &weights);
+
+  // Число деревьев кратчайших путей для выбора порядка вершин
+  static constexpr size_t ORDER_SAMPLE_COUNT = 64;
+  HubLabelsData data_;
+};
+
+template <typename Weight>
+template <typename ForEachEdge>
+void HubLabels<Weight>::AddHub(size_t vertex_count, VertexId root,
+  VertexId rank, const Label &root_label, std::vector<Label> &labels,
+  ForEachEdge for_each_edge) {
+  using SearchState = detail::SearchState<Weight>;
+
+  // Веса метки корня раскладываются по номерам хабов, чтобы проверка каждой
+  // вершины проходила только по её метке
+  static thread_local SearchState thread_states[2];
+  SearchState &state = thread_states[0];
+  SearchState &root_hubs = thread_states[1];
+  root_hubs.Reset(vertex_count);
+  for (const auto &[hub, weight] : root_label) {
+    root_hubs.Label(hub, weight, SearchState::NO_EDGE);
+  }
+
+  state.Reset(vertex_count);
+  state.Reach(root, Weight{}, SearchState::NO_EDGE);
+  while (const auto item = state.Pop()) {
+    const auto [weight, vertex] = *item;
+
+    auto &label = labels[vertex];
+    const bool is_covered = std::any_of(label.begin(), label.end(),
+      [&root_hubs, weight = weight](const auto &entry) {
+        return root_hubs.IsReached(entry.first)
+          && !(weight < root_hubs.weights[entry.first] + entry.second);
+      });
+    if (is_covered) {
+      continue;
+    }
+    label.emplace_back(rank, weight);
+
+    for_each_edge(vertex, [&state, weight = weight](VertexId next,
+      EdgeId edge_id, Weight edge_weight) {
+      const Weight candidate_weight = weight + edge_weight;
+      if (!state.IsReached(next) || candidate_weight < state.weights[next]) {
+        state.Reach(next, candidate_weight, edge_id);
+      }
+    });
+  }
+}
+
+// Вершины упорядочиваются по числу кратчайших путей, проходящих через них:
+// для вершины суммируются размеры её поддеревьев в деревьях кратчайших путей
+// из равномерно выбранных вершин. Такие вершины - обычно пересадочные
+// остановки - покрывают больше путей, и метки остальных вершин короче
+template <typename Weight>
+std::vector<VertexId> HubLabels<Weight>::GetVertexOrder(
+  const DirectedWeightedGraph<Weight> &graph) {
+  using SearchState = detail::SearchState<Weight>;
+
+  const size_t vertex_count = graph.GetVertexCount();
+  std::vector<size_t> path_counts(vertex_count, 0);
+  std::vector<size_t> subtree_sizes(vertex_count);
+  std::vector<VertexId> settled;
+  SearchState state;
+
+  const size_t sample_count = std::min(ORDER_SAMPLE_COUNT, vertex_count);
+  for (size_t sample = 0; sample < sample_count; ++sample) {
+    state.Reset(vertex_count);
+    state.Reach(sample * vertex_count / sample_count, Weight{},
+      SearchState::NO_EDGE);
+    settled.clear();
+    while (const auto item = state.Pop()) {
+      const auto [weight, vertex] = *item;
+      settled.push_back(vertex);
+      graph.ForEachIncidentEdge(vertex,
+        [&state, weight = weight](EdgeId edge_id, const Edge<Weight> &edge) {
+          const Weight candidate_weight = weight + edge.weight;
+          if (!state.IsReached(edge.to)
+            || candidate_weight < state.weights[edge.to]) {
+            state.Reach(edge.to, candidate_weight, edge_id);
+          }
+        });
+    }
+
+    // Вершины обходятся в порядке, обратном извлечению, поэтому поддерево
+    // вершины подсчитано раньше, чем она добавляется к родителю
+    for (const VertexId vertex : settled) {
+      subtree_sizes[vertex] = 1;
+    }
+    for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+      path_counts[*it] += subtree_sizes[*it];
+      if (const EdgeId prev_edge = state.prev_edges[*it];
+        prev_edge != SearchState::NO_EDGE) {
+        subtree_sizes[graph.GetEdge(prev_edge).from] += subtree_sizes[*it];
+      }
+    }
+  }
+
+  std::vector<VertexId> order(vertex_count);
+  std::iota(order.begin(), order.end(), VertexId{0});
+  std::stable_sort(order.begin(), order.end(),
+    [&path_counts](VertexId lhs, VertexId rhs) {
+      return path_counts[lhs] > path_counts[rhs];
+    });
+  return order;
+}
+
+// Метки строятся сокращённым поиском из вершин по порядку (pruned landmark
+// labeling): поиск из очередной вершины не раскрывает вершины, путь до
+// которых уже покрыт хабами, добавленными раньше
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const DirectedWeightedGraph<Weight> &graph) {
+  const size_t vertex_count = graph.GetVertexCount();
+  const IncomingEdges<Weight> incoming_edges(graph);
+  const auto order = GetVertexOrder(graph);
+
+  std::vector<Label> out_labels(vertex_count);
+  std::vector<Label> in_labels(vertex_count);
+  for (VertexId rank = 0; rank < vertex_count; ++rank) {
+    const VertexId root = order[rank];
+
+    // Прямой поиск даёт d(root, v) для входящих меток, обратный по входящим
+    // рёбрам - d(v, root) для исходящих
+    AddHub(vertex_count, root, rank, out_labels[root], in_labels,
+      [&graph](VertexId vertex, auto relax) {
+        graph.ForEachIncidentEdge(vertex,
+          [&relax](EdgeId edge_id, const Edge<Weight> &edge) {
+            relax(edge.to, edge_id, edge.weight);
+          });
+      });
+    AddHub(vertex_count, root, rank, in_labels[root], out_labels,
+      [&incoming_edges](VertexId vertex, auto relax) {
+        incoming_edges.ForEach(vertex,
+          [&relax](EdgeId edge_id, const Edge<Weight> &edge) {
+            relax(edge.from, edge_id, edge.weight);
+          });
+      });
+  }
+
+  FlattenLabels(out_labels, data_.out_offsets, data_.out_hubs,
+    data_.out_weights);
+  FlattenLabels(in_labels, data_.in_offsets, data_.in_hubs, data_.in_weights);
+}
+
+template <typename Weight>
+HubLabels<Weight>::HubLabels(const DirectedWeightedGraph<Weight> &graph,
+  HubLabelsData data)
+  : data_(std::move(data)) {
+  const size_t vertex_count = graph.GetVertexCount();
+  auto is_valid = [vertex_count](const std::vector<size_t> &offsets,
+    const std::vector<VertexId> &hubs, const std::vector<Weight> &weights) {
+    return offsets.size() == vertex_count + 1 && offsets.front() == 0
+      && std::is_sorted(offsets.begin(), offsets.end())
+      && offsets.back() == hubs.size() && hubs.size() == weights.size();
+  };
+  if (!is_valid(data_.out_offsets, data_.out_hubs, data_.out_weights)
+    || !is_valid(data_.in_offsets, data_.in_hubs, data_.in_weights)) {
+    throw std::invalid_argument("Hub labels data doesn't match the graph");
+  }
+}
+
+template <typename Weight>
+void HubLabels<Weight>::FlattenLabels(const std::vector<Label> &labels,
+  std::vector<size_t> &offsets, std::vector<VertexId> &hubs,
+  std::vector<Weight> &weights) {
+  offsets.assign(1, 0);
+  offsets.reserve(labels.size() + 1);
+  for (const auto &label : labels) {
+    offsets.push_back(offsets.back() + label.size());
+  }
+  hubs.reserve(offsets.back());
+  weights.reserve(offsets.back());
+  for (const auto &label : labels) {
+    for (const auto &[hub, weight] : label) {
+      hubs.push_back(hub);
+      weights.push_back(weight);
+    }
+  }
+}
+
+template <typename Weight>
+std::optional<Weight> HubLabels<Weight>::GetDistance(VertexId from,
+  VertexId to) const {
+  size_t out_it = data_.out_offsets.at(from);
+  const size_t out_end = data_.out_offsets[from + 1];
+  size_t in_it = data_.in_offsets.at(to);
+  const size_t in_end = data_.in_offsets[to + 1];
+
+  std::optional<Weight> distance;
+  while (out_it < out_end && in_it < in_end) {
+    const VertexId out_hub = data_.out_hubs[out_it];
+    const VertexId in_hub = data_.in_hubs[in_it];
+    if (out_hub < in_hub) {
+      ++out_it;
+    } else if (in_hub < out_hub) {
+      ++in_it;
+    } else {
+      const Weight weight = data_.out_weights[out_it++]
+        + data_.in_weights[in_it++];
+      if (!distance || weight < *distance) {
+        distance = weight;
+      }
+    }
+  }
+  return distance;
+}
+
+template <typename Weight>
+const typename HubLabels<Weight>::HubLabelsData &
+HubLabels<Weight>::GetHubLabelsData() const {
+  return data_;
+}
+
+template <typename Weight>
+double HubLabels<Weight>::GetAverageLabelSize() const {
+  const size_t vertex_count = data_.out_offsets.size() - 1;
+  if (vertex_count == 0) {
+    return 0;
+  }
+  return static_cast<double>(data_.out_hubs.size() + data_.in_hubs.size())
+    / static_cast<double>(2 * vertex_count);
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::GetMaxLabelSize() const {
+  size_t max_size = 0;
+  for (const auto *offsets : {&data_.out_offsets, &data_.in_offsets}) {
+    for (size_t vertex = 0; vertex + 1 < offsets->size(); ++vertex) {
+      max_size = std::max(max_size, (*offsets)[vertex + 1] - (*offsets)[vertex]);
+    }
+  }
+  return max_size;
+}
+
+template <typename Weight>
+size_t HubLabels<Weight>::GetMemoryUsage() const {
+  return (data_.out_offsets.size() + data_.in_offsets.size()) * sizeof(size_t)
+    + (data_.out_hubs.size() + data_.in_hubs.size())
+      * (sizeof(VertexId) + sizeof(Weight));
+}
+
+}  // namespace graph
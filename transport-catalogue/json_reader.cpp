@@ -5,9 +5,12 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <algorithm>
 #include <chrono>
+#include <limits>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <variant>
 
 namespace tc {
@@ -28,7 +31,7 @@ void AddStopsToDB(TransportCatalogue &cat, json::Array &data,
       auto lng = map_req.at("longitude"s).AsDouble();
       distances[name] = map_req.at("road_distances"s).AsMap();
 
-      cat.AddStop({name, lat, lng});
+      cat.AddStop(name, {lat, lng});
     }
   }
 }
@@ -39,9 +42,8 @@ void AddDistancesToDB(TransportCatalogue &cat,
     for (const auto &[stop_b_name, dist] : map_distances) {
       auto a = cat.GetStop(stop_a_name);
       auto b = cat.GetStop(stop_b_name);
-      auto stops = std::make_pair(a, b);
 
-      cat.SetDistance(stops, dist.AsInt());
+      cat.SetDistance(a->id, b->id, dist.AsInt());
     }
   }
 }
@@ -57,26 +59,14 @@ void AddRoutesToDB(TransportCatalogue &cat, json::Array &data) {
       auto name = map_req.at("name"s).AsString();
       auto is_roundtrip = map_req.at("is_roundtrip"s).AsBool();
       auto stops = map_req.at("stops"s).AsArray();
-      Route route;
-      Route final_stops;
+      std::vector<StopId> route;
 
+      route.reserve(stops.size());
       for (const auto &stop: stops) {
-        route.push_back(cat.GetStop(stop.AsString()));
+        route.push_back(cat.GetStop(stop.AsString())->id);
       }
 
-      // Определение конечных остановок
-      final_stops.push_back(route.front());
-      if (route.front() != route.back()) {
-        final_stops.push_back(route.back());
-      }
-
-      // Приведение маршрута вида "stop1 - stop2 - ... stopN" к виду
-      // "stop1 > stop2 > ... > stopN-1 > stopN > stopN-1 > ... > stop2 > stop1"
-      if (!is_roundtrip) {
-        route.insert(route.end(), route.rbegin() + 1, route.rend());
-      }
-
-      cat.AddRoute({name, route, final_stops});
+      cat.AddRoute(name, route, is_roundtrip);
     }
   }
 }
@@ -93,6 +83,11 @@ void FillDB(TransportCatalogue &cat, json::Array &data)
 
   // Добавление маршрутов в базу данных
   AddRoutesToDB(cat, data);
+
+  // Имена больше не меняются, поиск по ним переходит на индексы
+  cat.BuildNameIndexes();
+  cat.BuildStopSearch();
+  cat.BuildSpatialIndex();
 }
 
 } // namespace filler
@@ -116,6 +111,57 @@ void PrintStops(const RequestHandler &handler, std::string &name,
   builder.EndArray();
 }
 
+void PrintStopSearch(const RequestHandler &handler, const json::Dict &request,
+  json::Builder &builder) {
+  using namespace std::string_literals;
+
+  // Число подсказок по умолчанию
+  static const int default_limit = 10;
+
+  int limit = default_limit;
+  if (const auto it = request.find("limit"s); it != request.end()) {
+    limit = std::max(it->second.AsInt(), 0);
+  }
+
+  builder.Key("stops"s).StartArray();
+  for (const Stop *stop : handler.SearchStops(request.at("query"s).AsString(),
+    static_cast<size_t>(limit))) {
+    builder.Value(stop->name);
+  }
+  builder.EndArray();
+}
+
+void PrintNearestStops(const RequestHandler &handler,
+  const json::Dict &request, json::Builder &builder) {
+  using namespace std::string_literals;
+
+  // Число остановок по умолчанию
+  static const int default_count = 10;
+
+  const geo::Coordinates coordinates = {
+    request.at("latitude"s).AsDouble(),
+    request.at("longitude"s).AsDouble()
+  };
+  double radius = std::numeric_limits<double>::infinity();
+  if (const auto it = request.find("radius"s); it != request.end()) {
+    radius = it->second.AsDouble();
+  }
+  int count = default_count;
+  if (const auto it = request.find("count"s); it != request.end()) {
+    count = std::max(it->second.AsInt(), 0);
+  }
+
+  builder.Key("stops"s).StartArray();
+  for (const auto &[stop, distance] : handler.FindNearestStops(coordinates,
+    radius, static_cast<size_t>(count))) {
+    builder.StartDict()
+      .Key("stop_name"s).Value(stop->name)
+      .Key("distance"s).Value(distance)
+      .EndDict();
+  }
+  builder.EndArray();
+}
+
 void PrintBuses(const RequestHandler &handler, std::string &name,
   json::Builder &builder) {
   using namespace std::string_literals;
@@ -158,10 +204,11 @@ void BuildRouteItem(json::Builder &builder,
 }
 
 void PrintRoute(const RequestHandler &handler, std::string &from,
-  std::string &to, json::Builder &builder) {
+  std::string &to, const router::RoutingOverrides &overrides,
+  json::Builder &builder) {
   using namespace std::string_literals;
 
-  const auto route = handler.FindRoute(from, to);
+  const auto route = handler.FindRoute(from, to, overrides);
   if (!route.has_value()) {
     builder.Key("error_message"s).Value("not found"s);
     return;
@@ -184,6 +231,98 @@ void PrintRoute(const RequestHandler &handler, std::string &from,
   builder.EndArray();
 }
 
+void PrintRouteTime(const RequestHandler &handler, std::string &from,
+  std::string &to, const router::RoutingOverrides &overrides,
+  json::Builder &builder) {
+  using namespace std::string_literals;
+
+  const auto total_time = handler.FindRouteTime(from, to, overrides);
+  if (!total_time.has_value()) {
+    builder.Key("error_message"s).Value("not found"s);
+    return;
+  }
+
+  builder.Key("total_time"s).Value(*total_time);
+}
+
+void PrintReachable(const RequestHandler &handler, std::string &from,
+  double max_time, const router::RoutingOverrides &overrides,
+  json::Builder &builder) {
+  using namespace std::string_literals;
+
+  const auto stops = handler.FindReachableStops(from, max_time, overrides);
+  if (!stops.has_value()) {
+    builder.Key("error_message"s).Value("not found"s);
+    return;
+  }
+
+  builder.Key("stops"s).StartArray();
+  for (const auto &[stop, total_time] : *stops) {
+    builder.StartDict()
+      .Key("stop_name"s).Value(stop->name)
+      .Key("total_time"s).Value(total_time.count())
+      .EndDict();
+  }
+  builder.EndArray();
+}
+
+void PrintRouteMatrix(const RequestHandler &handler,
+  const json::Array &from, const json::Array &to,
+  const router::RoutingOverrides &overrides, json::Builder &builder) {
+  using namespace std::string_literals;
+
+  auto read_names = [](const json::Array &names) {
+    std::vector<std::string_view> result;
+    result.reserve(names.size());
+    for (const auto &name : names) {
+      result.emplace_back(name.AsString());
+    }
+    return result;
+  };
+
+  const auto matrix = handler.FindRouteMatrix(read_names(from),
+    read_names(to), overrides);
+  if (!matrix.has_value()) {
+    builder.Key("error_message"s).Value("not found"s);
+    return;
+  }
+
+  // Отсутствующий маршрут обозначается значением null
+  builder.Key("total_times"s).StartArray();
+  for (const auto &row : matrix->total_times) {
+    builder.StartArray();
+    for (const auto &total_time : row) {
+      if (total_time.has_value()) {
+        builder.Value(total_time->count());
+      } else {
+        builder.Value(nullptr);
+      }
+    }
+    builder.EndArray();
+  }
+  builder.EndArray();
+}
+
+void SetClosures(RequestHandler &handler, const json::Dict &request,
+  json::Builder &builder) {
+  using namespace std::string_literals;
+
+  // Отсутствующий список означает, что закрытий этого вида нет
+  auto read_names = [&request](const std::string &key) {
+    std::vector<std::string_view> result;
+    if (const auto it = request.find(key); it != request.end()) {
+      for (const auto &name : it->second.AsArray()) {
+        result.emplace_back(name.AsString());
+      }
+    }
+    return result;
+  };
+
+  if (!handler.SetClosures(read_names("stops"s), read_names("buses"s))) {
+    builder.Key("error_message"s).Value("not found"s);
+  }
+}
+
 void PrintMap(const RequestHandler &handler, json::Builder &builder) {
   using namespace std::string_literals;
 
@@ -206,19 +345,48 @@ void ProcessQueries(json::Array &data, RequestHandler &handler,
     auto req_type = map_req.at("type"s);
     std::string name, from, to;
 
+    // Переопределения параметров маршрутизации для запроса (необязательные)
+    router::RoutingOverrides overrides;
+    if (const auto it = map_req.find("routing_overrides"s);
+      it != map_req.end()) {
+      overrides = router::ReadRoutingOverrides(it->second.AsMap());
+    }
+
     json_builder.StartDict()
       .Key("request_id").Value(map_req.at("id"s).AsInt());
 
     if (req_type == "Stop"s) {
       name = map_req.at("name"s).AsString();
       PrintStops(handler, name, json_builder);
+    } else if (req_type == "StopSearch"s) {
+      PrintStopSearch(handler, map_req, json_builder);
+    } else if (req_type == "NearestStops"s) {
+      PrintNearestStops(handler, map_req, json_builder);
     } else if (req_type == "Bus"s) {
       name = map_req.at("name"s).AsString();
       PrintBuses(handler, name, json_builder);
     }else if (req_type == "Route"s) {
       from = map_req.at("from"s).AsString();
       to = map_req.at("to"s).AsString();
-      PrintRoute(handler, from, to, json_builder);
+
+      // Без описания маршрута, если нужно только время в пути
+      const auto it = map_req.find("total_time_only"s);
+      if (it != map_req.end() && it->second.AsBool()) {
+        PrintRouteTime(handler, from, to, overrides, json_builder);
+      } else {
+        PrintRoute(handler, from, to, overrides, json_builder);
+      }
+    } else if (req_type == "Reachable"s) {
+      from = map_req.at("from"s).AsString();
+      PrintReachable(handler, from, map_req.at("max_time"s).AsDouble(),
+        overrides, json_builder);
+    } else if (req_type == "RouteMatrix"s) {
+      PrintRouteMatrix(handler, map_req.at("from"s).AsArray(),
+        map_req.at("to"s).AsArray(), overrides, json_builder);
+    } else if (req_type == "SetClosures"s) {
+      SetClosures(handler, map_req, json_builder);
+    } else if (req_type == "ClearClosures"s) {
+      handler.ClearClosures();
     } else if (req_type == "Map"s) {
       PrintMap(handler, json_builder);
     }
@@ -293,6 +461,21 @@ RenderSettings ReadRenderSettings(const json::Dict &settings) {
 
 namespace router {
 
+namespace {
+// Неотрицательный целый параметр маршрутизации: отрицательное значение после
+// приведения к беззнаковому типу стало бы огромным
+uint32_t ReadCount(const json::Node &json, const std::string &name) {
+  using namespace std::string_literals;
+
+  const int value = json.AsInt();
+  if (value < 0) {
+    throw std::invalid_argument("Negative routing setting: "s + name);
+  }
+  return static_cast<uint32_t>(value);
+}
+
+} // namespace
+
 RoutingSettings ReadRoutingSettings(const json::Dict &settings) {
   using namespace std::string_literals;
 
@@ -301,9 +484,99 @@ RoutingSettings ReadRoutingSettings(const json::Dict &settings) {
   rs.bus_wait_time = std::chrono::minutes(bus_wait_time);
   rs.bus_velocity = settings.at("bus_velocity"s).AsDouble();
 
+  // Движок поиска маршрутов (необязательный параметр)
+  if (const auto it = settings.find("router_type"s); it != settings.end()) {
+    const auto &router_type = it->second.AsString();
+
+    if (router_type == "all_pairs"s) {
+      rs.router_type = RouterType::ALL_PAIRS;
+    } else if (router_type == "dijkstra"s) {
+      rs.router_type = RouterType::DIJKSTRA;
+    } else if (router_type == "contraction_hierarchy"s) {
+      rs.router_type = RouterType::CONTRACTION_HIERARCHY;
+    } else if (router_type == "raptor"s) {
+      rs.router_type = RouterType::RAPTOR;
+    } else if (router_type == "a_star"s) {
+      rs.router_type = RouterType::A_STAR;
+    } else if (router_type == "bidirectional_a_star"s) {
+      rs.router_type = RouterType::BIDIRECTIONAL_A_STAR;
+    } else if (router_type == "alt"s) {
+      rs.router_type = RouterType::ALT;
+    } else if (router_type == "auto"s) {
+      rs.router_type = RouterType::AUTO;
+    } else {
+      throw std::invalid_argument("Unknown router type: "s + router_type);
+    }
+  }
+
+  // Бюджет памяти движка в мегабайтах (необязательный параметр). Без явно
+  // заданного движка включает его автоматический выбор
+  if (const auto it = settings.find("memory_budget_mb"s);
+    it != settings.end()) {
+    const size_t memory_budget_mb = ReadCount(it->second, it->first);
+    if (memory_budget_mb > std::numeric_limits<size_t>::max() >> 20) {
+      throw std::invalid_argument("Routing setting out of range: "s
+        + it->first);
+    }
+    rs.memory_budget = memory_budget_mb << 20;
+    if (settings.count("router_type"s) == 0) {
+      rs.router_type = RouterType::AUTO;
+    }
+  }
+
+  // Порядок нумерации вершин графа (необязательный параметр)
+  if (const auto it = settings.find("vertex_order"s); it != settings.end()) {
+    const auto &vertex_order = it->second.AsString();
+
+    if (vertex_order == "catalogue"s) {
+      rs.vertex_order = VertexOrder::CATALOGUE;
+    } else if (vertex_order == "hilbert"s) {
+      rs.vertex_order = VertexOrder::HILBERT;
+    } else {
+      throw std::invalid_argument("Unknown vertex order: "s + vertex_order);
+    }
+  }
+
+  // Число потоков предварительного расчёта маршрутов (необязательный параметр)
+  if (const auto it = settings.find("thread_count"s); it != settings.end()) {
+    rs.thread_count = ReadCount(it->second, it->first);
+  }
+
+  // Число ориентиров для поиска A* с ориентирами (необязательный параметр)
+  if (const auto it = settings.find("landmark_count"s); it != settings.end()) {
+    rs.landmark_count = ReadCount(it->second, it->first);
+  }
+
+  // Построение меток хабов (необязательный параметр)
+  if (const auto it = settings.find("hub_labels"s); it != settings.end()) {
+    rs.hub_labels = it->second.AsBool();
+  }
+
+  // Размер кэша маршрутов (необязательный параметр)
+  if (const auto it = settings.find("route_cache_capacity"s);
+    it != settings.end()) {
+    rs.route_cache_capacity = ReadCount(it->second, it->first);
+  }
+
   return rs;
 }
 
+RoutingOverrides ReadRoutingOverrides(const json::Dict &overrides) {
+  using namespace std::string_literals;
+
+  RoutingOverrides ro;
+  if (const auto it = overrides.find("bus_wait_time"s);
+    it != overrides.end()) {
+    ro.bus_wait_time = std::chrono::minutes(it->second.AsInt());
+  }
+  if (const auto it = overrides.find("bus_velocity"s);
+    it != overrides.end()) {
+    ro.bus_velocity = it->second.AsDouble();
+  }
+
+  return ro;
+}
+
 } // namespace router
 
 } // namespace tc
@@ -35,6 +35,9 @@ namespace router {
 struct RoutingSettings;
 RoutingSettings ReadRoutingSettings(const json::Dict &router_settings);
 
+struct RoutingOverrides;
+RoutingOverrides ReadRoutingOverrides(const json::Dict &overrides);
+
 } // namespace router
 
 } // namespace tc
\ No newline at end of file
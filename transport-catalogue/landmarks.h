@@ -0,0 +1,227 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Ориентиры для оценки расстояний по неравенству треугольника (ALT). Для
+// каждого ориентира L заранее рассчитываются расстояния d(L, v) и d(v, L) до
+// всех вершин, после чего для любой пары вершин
+//   d(u, v) >= max(d(L, v) - d(L, u), d(u, L) - d(v, L)).
+// Такая оценка согласована и подходит для поиска A*. Память линейна по числу
+// вершин: два массива расстояний на ориентир
+template <typename Weight>
+class Landmarks {
+public:
+  // Расстояния хранятся по вершинам: значения всех ориентиров для вершины v
+  // занимают [v * landmark_count, (v + 1) * landmark_count). Отрицательное
+  // расстояние обозначает недостижимость
+  struct LandmarksData {
+    std::vector<VertexId> landmarks;
+    std::vector<Weight> from_landmarks;  // d(L, v)
+    std::vector<Weight> to_landmarks;    // d(v, L)
+  };
+
+  Landmarks(const DirectedWeightedGraph<Weight> &graph, size_t landmark_count);
+
+  // Восстанавливает ориентиры по ранее рассчитанным расстояниям
+  Landmarks(const DirectedWeightedGraph<Weight> &graph, LandmarksData data);
+
+  Weight GetLowerBound(VertexId from, VertexId to) const;
+
+  const LandmarksData &GetLandmarksData() const;
+  size_t GetLandmarkCount() const;
+
+  // Объём памяти, занимаемый массивами расстояний, в байтах
+  size_t GetMemoryUsage() const;
+
+private:
+  using Distances = std::vector<std::optional<Weight>>;
+
+  // Расстояния от source по рёбрам графа или, если задан incoming_edges, до
+  // source по входящим рёбрам
+  Distances ComputeDistances(VertexId source,
+    const IncomingEdges<Weight> *incoming_edges) const;
+
+  static constexpr Weight ZERO_WEIGHT{};
+  static constexpr double BOUND_SCALE = 1 - 1e-9;
+  const DirectedWeightedGraph<Weight> &graph_;
+  LandmarksData data_;
+};
+
+template <typename Weight>
+typename Landmarks<Weight>::Distances
+Landmarks<Weight>::ComputeDistances(VertexId source,
+  const IncomingEdges<Weight> *incoming_edges) const {
+  detail::SearchState<Weight> state;
+  state.Reset(graph_.GetVertexCount());
+  state.Reach(source, ZERO_WEIGHT, detail::SearchState<Weight>::NO_EDGE);
+
+  while (const auto item = state.Pop()) {
+    const auto [weight, vertex] = *item;
+    auto relax = [&state, weight = weight](VertexId next, EdgeId edge_id,
+      Weight edge_weight) {
+      const Weight candidate_weight = weight + edge_weight;
+      if (!state.IsReached(next) || candidate_weight < state.weights[next]) {
+        state.Reach(next, candidate_weight, edge_id);
+      }
+    };
+
+    if (incoming_edges == nullptr) {
+      graph_.ForEachIncidentEdge(vertex,
+        [&relax](EdgeId edge_id, const Edge<Weight> &edge) {
+          relax(edge.to, edge_id, edge.weight);
+        });
+    } else {
+      incoming_edges->ForEach(vertex,
+        [&relax](EdgeId edge_id, const Edge<Weight> &edge) {
+          relax(edge.from, edge_id, edge.weight);
+        });
+    }
+  }
+
+  Distances distances(graph_.GetVertexCount());
+  for (VertexId vertex = 0; vertex < distances.size(); ++vertex) {
+    if (state.IsReached(vertex)) {
+      distances[vertex] = state.weights[vertex];
+    }
+  }
+  return distances;
+}
+
+// Ориентиры выбираются по принципу наиболее удалённой вершины: первый -
+// вершина, самая далёкая от произвольной начальной, каждый следующий - самая
+// далёкая от уже выбранных. Недостижимые вершины выбираются в первую очередь,
+// чтобы ориентиры были в каждой компоненте графа. Кандидатами служат только
+// вершины, из которых выходят рёбра линий
+template <typename Weight>
+Landmarks<Weight>::Landmarks(const DirectedWeightedGraph<Weight> &graph,
+  size_t landmark_count)
+  : graph_(graph) {
+  const size_t vertex_count = graph.GetVertexCount();
+  const IncomingEdges<Weight> incoming_edges(graph);
+
+  std::vector<VertexId> candidates;
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    const auto line_stops = graph.GetLineStops(vertex);
+    if (line_stops.begin() != line_stops.end()) {
+      candidates.push_back(vertex);
+    }
+  }
+  landmark_count = std::min(landmark_count, candidates.size());
+
+  // Наименьшее расстояние от выбранных ориентиров до каждой вершины
+  Distances nearest(vertex_count);
+  if (landmark_count > 0) {
+    nearest = ComputeDistances(candidates.front(), nullptr);
+  }
+  std::vector<Distances> from_landmarks;
+  std::vector<Distances> to_landmarks;
+
+  // Вершина lhs ближе к ориентирам, чем rhs
+  auto is_nearer = [&nearest](VertexId lhs, VertexId rhs) {
+    if (!nearest[lhs]) {
+      return false;
+    }
+    return !nearest[rhs] || *nearest[lhs] < *nearest[rhs];
+  };
+
+  for (size_t i = 0; i < landmark_count; ++i) {
+    const VertexId landmark =
+      *std::max_element(candidates.begin(), candidates.end(), is_nearer);
+    if (i == 0) {
+      nearest.assign(vertex_count, std::nullopt);
+    }
+
+    data_.landmarks.push_back(landmark);
+    from_landmarks.push_back(ComputeDistances(landmark, nullptr));
+    to_landmarks.push_back(ComputeDistances(landmark, &incoming_edges));
+
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+      const auto &distance = from_landmarks.back()[vertex];
+      if (distance && (!nearest[vertex] || *distance < *nearest[vertex])) {
+        nearest[vertex] = distance;
+      }
+    }
+  }
+
+  const Weight unreachable = Weight(-1);
+  data_.from_landmarks.resize(vertex_count * landmark_count);
+  data_.to_landmarks.resize(vertex_count * landmark_count);
+  for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+    for (size_t i = 0; i < landmark_count; ++i) {
+      const size_t index = vertex * landmark_count + i;
+      data_.from_landmarks[index] =
+        from_landmarks[i][vertex].value_or(unreachable);
+      data_.to_landmarks[index] = to_landmarks[i][vertex].value_or(unreachable);
+    }
+  }
+}
+
+template <typename Weight>
+Landmarks<Weight>::Landmarks(const DirectedWeightedGraph<Weight> &graph,
+  LandmarksData data)
+  : graph_(graph)
+  , data_(std::move(data)) {
+  const size_t size = graph.GetVertexCount() * data_.landmarks.size();
+  if (data_.from_landmarks.size() != size
+    || data_.to_landmarks.size() != size) {
+    throw std::invalid_argument("Landmarks data doesn't match the graph");
+  }
+}
+
+template <typename Weight>
+Weight Landmarks<Weight>::GetLowerBound(VertexId from, VertexId to) const {
+  const size_t landmark_count = data_.landmarks.size();
+  const Weight *from_landmarks_from =
+    data_.from_landmarks.data() + from * landmark_count;
+  const Weight *from_landmarks_to =
+    data_.from_landmarks.data() + to * landmark_count;
+  const Weight *to_landmarks_from =
+    data_.to_landmarks.data() + from * landmark_count;
+  const Weight *to_landmarks_to =
+    data_.to_landmarks.data() + to * landmark_count;
+
+  // Слагаемые с недостижимыми расстояниями ничего не сообщают о d(from, to)
+  Weight bound = ZERO_WEIGHT;
+  for (size_t i = 0; i < landmark_count; ++i) {
+    if (!(from_landmarks_from[i] < ZERO_WEIGHT)
+      && !(from_landmarks_to[i] < ZERO_WEIGHT)) {
+      bound = std::max(bound, from_landmarks_to[i] - from_landmarks_from[i]);
+    }
+    if (!(to_landmarks_from[i] < ZERO_WEIGHT)
+      && !(to_landmarks_to[i] < ZERO_WEIGHT)) {
+      bound = std::max(bound, to_landmarks_from[i] - to_landmarks_to[i]);
+    }
+  }
+
+  // Небольшой запас компенсирует погрешность вычислений с плавающей точкой
+  return bound * BOUND_SCALE;
+}
+
+template <typename Weight>
+const typename Landmarks<Weight>::LandmarksData &
+Landmarks<Weight>::GetLandmarksData() const {
+  return data_;
+}
+
+template <typename Weight>
+size_t Landmarks<Weight>::GetLandmarkCount() const {
+  return data_.landmarks.size();
+}
+
+template <typename Weight>
+size_t Landmarks<Weight>::GetMemoryUsage() const {
+  return sizeof(VertexId) * data_.landmarks.size()
+    + sizeof(Weight) * (data_.from_landmarks.size()
+      + data_.to_landmarks.size());
+}
+
+}  // namespace graph
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+// Потокобезопасный кэш ограниченного размера с вытеснением давно не
+// использованных записей (LRU). Все операции выполняются под одной
+// блокировкой, счётчики попаданий и промахов читаются без неё
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+  explicit LruCache(size_t capacity);
+
+  // Возвращает копию значения и делает запись самой свежей
+  std::optional<Value> Get(const Key &key);
+  void Put(const Key &key, Value value);
+  void Clear();
+
+  size_t GetCapacity() const;
+  size_t GetSize() const;
+  size_t GetHitCount() const;
+  size_t GetMissCount() const;
+
+private:
+  using Entry = std::pair<Key, Value>;
+  using EntryList = std::list<Entry>;
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  EntryList entries_;  // От самой свежей записи к самой старой
+  std::unordered_map<Key, typename EntryList::iterator, Hash> index_;
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
+};
+
+template <typename Key, typename Value, typename Hash>
+LruCache<Key, Value, Hash>::LruCache(size_t capacity)
+  : capacity_(capacity) {
+}
+
+template <typename Key, typename Value, typename Hash>
+std::optional<Value> LruCache<Key, Value, Hash>::Get(const Key &key) {
+  std::lock_guard lock(mutex_);
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    miss_count_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  hit_count_.fetch_add(1, std::memory_order_relaxed);
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->second;
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Put(const Key &key, Value value) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  std::lock_guard lock(mutex_);
+  if (const auto it = index_.find(key); it != index_.end()) {
+    it->second->second = std::move(value);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  // Самая старая запись переиспользуется для новой без лишнего выделения
+  if (entries_.size() == capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+    entries_.front() = Entry{key, std::move(value)};
+  } else {
+    entries_.emplace_front(key, std::move(value));
+  }
+  index_.emplace(key, entries_.begin());
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Clear() {
+  std::lock_guard lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetCapacity() const {
+  return capacity_;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetSize() const {
+  std::lock_guard lock(mutex_);
+  return entries_.size();
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetHitCount() const {
+  return hit_count_.load(std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetMissCount() const {
+  return miss_count_.load(std::memory_order_relaxed);
+}
+
+}  // namespace cache
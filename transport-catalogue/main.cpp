@@ -27,6 +27,7 @@ int main(int argc, char* argv[]) {
   auto render_set = "render_settings"s;
   auto routing_set = "routing_settings"s;
   auto serialization_settings = "serialization_settings"s;
+  auto routing_overrides = "routing_overrides"s;
   json::Array json;
   tc::renderer::RenderSettings render_settings;
   tc::router::RoutingSettings routing_settings;
@@ -51,15 +52,29 @@ int main(int argc, char* argv[]) {
     routing_settings =
       tc::router::ReadRoutingSettings(doc.at(routing_set).AsMap());
     tc::router::TransportRouter router{routing_settings, cat};
+    router.ReportBuildStats(std::cerr);
 
     // Сериализация базы данных
-    tc::serial::SerializeDB(cat, render_settings, router, file);
+    if (!tc::serial::SerializeDB(cat, render_settings, router, file,
+      std::cerr)) {
+      std::cerr << "Failed to write the base to "s << file << std::endl;
+      return EXIT_FAILURE;
+    }
 
   } else if (mode == "process_requests"sv) {
     tc::router::TransportRouter router;
 
     // Десериализация базы данных
-    tc::serial::DeserializeDB(cat, render_settings, router, file);
+    if (!tc::serial::DeserializeDB(cat, render_settings, router, file)) {
+      std::cerr << "Failed to read the base from "s << file << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Переопределения параметров маршрутизации для всех запросов пакета
+    if (doc.find(routing_overrides) != doc.end()) {
+      router.SetBatchOverrides(tc::router::ReadRoutingOverrides(
+        doc.at(routing_overrides).AsMap()));
+    }
 
     // Настройка рендеринга
     tc::renderer::MapRenderer renderer;
@@ -70,6 +85,7 @@ int main(int argc, char* argv[]) {
     if (doc.find(stat_req) != doc.end()) {
       json = doc.at(stat_req).AsArray();
       tc::printer::ProcessQueries(json, handler, std::cout);
+      router.ReportQueryStats(std::cerr);
     }
   } else {
     PrintUsage();
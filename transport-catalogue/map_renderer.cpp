@@ -69,27 +69,31 @@ private:
 
 } // namespace
 
-Map::Map(RenderSettings settings, std::vector<Bus *> buses)
-    : settings_(std::move(settings)) , buses_(std::move(buses)) {
-  std::sort(buses_.begin(), buses_.end(), [](Bus *lhs, Bus *rhs) {
+Map::Map(RenderSettings settings, const TransportCatalogue &cat)
+    : settings_(std::move(settings)), cat_(cat) {
+  for (const auto &bus : cat_.GetBuses()) {
+    buses_.push_back(&bus);
+  }
+  std::sort(buses_.begin(), buses_.end(), [](const Bus *lhs, const Bus *rhs) {
     return lhs->name < rhs->name;
   });
 
-  std::unordered_set<Stop *> stops;
+  std::unordered_set<StopId> stops;
   for (const auto bus : buses_) {
-    stops.insert(bus->stops.begin(), bus->stops.end());
+    const auto route = cat_.GetRoute(bus->id);
+    stops.insert(route.begin(), route.end());
   }
 
   std::vector<geo::Coordinates> positions;
   positions.reserve(stops.size());
   for (const auto stop : stops) {
-    positions.push_back({stop->lat, stop->lng});
+    positions.push_back(cat_.GetCoordinates(stop));
   }
 
   SphereProjector projector{positions.begin(), positions.end(), settings_.width,
     settings_.height, settings_.padding};
   for (const auto stop : stops) {
-    stops_positions_[stop] = projector({stop->lat, stop->lng});
+    stops_positions_[&cat_.GetStop(stop)] = projector(cat_.GetCoordinates(stop));
   }
 }
 
@@ -104,9 +108,9 @@ void Map::RenderBusLines(svg::ObjectContainer &container) const {
   size_t bus_index = 0;
 
   for (const auto bus : buses_) {
-    auto &stops = bus->stops;
+    const auto stops = cat_.GetRoute(bus->id);
 
-    if (!stops.empty()) {
+    if (bus->route_size > 0) {
       auto line = svg::Polyline()
         .SetStrokeColor(GetBusLineColor(bus_index++))
         .SetStrokeWidth(settings_.line_width)
@@ -115,7 +119,7 @@ void Map::RenderBusLines(svg::ObjectContainer &container) const {
         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
       for (const auto stop : stops) {
-        line.AddPoint(stops_positions_.at(stop));
+        line.AddPoint(GetStopPosition(stop));
       }
       container.Add(std::move(line));
     }
@@ -128,14 +132,14 @@ void Map::RenderBusLabels(svg::ObjectContainer &container) const {
   size_t bus_index = 0;
 
   for (const auto bus : buses_) {
-    if (bus->stops.empty()) {
+    if (bus->route_size == 0) {
       continue;
     }
 
     auto &bus_color = GetBusLineColor(bus_index++);
 
     for (const auto stop : bus->final_stops) {
-      auto &stop_pos = stops_positions_.at(stop);
+      auto &stop_pos = GetStopPosition(stop);
       auto base = svg::Text()
         .SetPosition(stop_pos)
         .SetOffset(settings_.bus_label_offset)
@@ -194,10 +198,19 @@ const svg::Color &Map::GetBusLineColor(size_t index) const {
   return !palette.empty() ? palette[index % palette.size()] : default_color;
 }
 
-bool Map::LexicSorterByName::operator()(Stop *lhs, Stop *rhs) const {
+const svg::Point &Map::GetStopPosition(StopId id) const {
+  return stops_positions_.at(&cat_.GetStop(id));
+}
+
+bool Map::LexicSorterByName::operator()(const Stop *lhs,
+  const Stop *rhs) const {
   return lhs->name < rhs->name;
 }
 
+Map MapRenderer::RenderMap(const TransportCatalogue &cat) const {
+  return {settings_, cat};
+}
+
 MapRenderer::MapRenderer(RenderSettings settings)
   : settings_(std::move(settings)) {
 }
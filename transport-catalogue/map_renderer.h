@@ -2,6 +2,7 @@
 
 #include "domain.h"
 #include "svg.h"
+#include "transport_catalogue.h"
 
 #include <cassert>
 #include <map>
@@ -28,7 +29,8 @@ struct RenderSettings {
 
 class Map : public svg::Drawable {
 public:
-  Map(RenderSettings settings, std::vector<Bus *> buses);
+  // Справочник должен существовать, пока карта используется
+  Map(RenderSettings settings, const TransportCatalogue &cat);
 
   void Draw(svg::ObjectContainer &container) const override;
 
@@ -41,12 +43,15 @@ private:
   const svg::Color &GetBusLineColor(size_t index) const;
 
   struct LexicSorterByName {
-    bool operator()(Stop *lhs, Stop *rhs) const;
+    bool operator()(const Stop *lhs, const Stop *rhs) const;
   };
 
+  const svg::Point &GetStopPosition(StopId id) const;
+
   RenderSettings settings_;
-  std::vector<Bus *> buses_;
-  std::map<Stop *, svg::Point, LexicSorterByName> stops_positions_;
+  const TransportCatalogue &cat_;
+  std::vector<const Bus *> buses_;
+  std::map<const Stop *, svg::Point, LexicSorterByName> stops_positions_;
 };
 
 
@@ -55,23 +60,10 @@ public:
   MapRenderer() = default;
   MapRenderer(RenderSettings settings);
 
-  template <typename Iterator>
-  Map RenderMap(Iterator begin, Iterator end) const;
+  Map RenderMap(const TransportCatalogue &cat) const;
 
 private:
   RenderSettings settings_;
 };
 
-template <typename Iterator>
-Map MapRenderer::RenderMap(Iterator begin, Iterator end) const {
-  std::vector<Bus *> buses;
-
-  while (begin != end) {
-    buses.emplace_back(&(*begin));
-    ++begin;
-  }
-
-  return {settings_, std::move(buses)};
-}
-
 }  // namespace tc::renderer
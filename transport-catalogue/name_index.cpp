@@ -0,0 +1,162 @@
+#include "name_index.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace tc {
+
+namespace {
+
+// Среднее число имён в корзине. Крупные корзины экономят память на смещениях,
+// но удлиняют их подбор
+const size_t BUCKET_SIZE = 4;
+
+// Предел подбора смещения одной корзины, после которого построение
+// повторяется с другим зерном хеша
+const uint32_t MAX_DISPLACEMENT = 1u << 20;
+
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111eb;
+  value ^= value >> 31;
+  return value;
+}
+
+} // namespace
+
+NameIndex::NameIndex(const std::vector<std::string_view> &names) {
+  if (names.empty()) {
+    return;
+  }
+
+  std::unordered_map<std::string_view, uint32_t> last_ids;
+  for (uint32_t id = 0; id < names.size(); ++id) {
+    last_ids[names[id]] = id;
+  }
+  std::vector<uint32_t> ids;
+  ids.reserve(last_ids.size());
+  for (uint32_t id = 0; id < names.size(); ++id) {
+    if (last_ids.at(names[id]) == id) {
+      ids.push_back(id);
+    }
+  }
+
+  data_.name_count = static_cast<uint32_t>(names.size());
+  while (!TryBuild(names, ids)) {
+    ++data_.seed;
+  }
+}
+
+NameIndex::NameIndex(NameIndexData data) : data_(std::move(data)) {
+  const bool is_valid = data_.displacements.empty() == data_.ids.empty()
+    && data_.ids.size() <= data_.name_count
+    && std::all_of(data_.ids.begin(), data_.ids.end(),
+      [this](uint32_t id) {
+        return id < data_.name_count;
+      });
+  if (!is_valid) {
+    throw std::invalid_argument("Name index data is inconsistent");
+  }
+}
+
+std::optional<uint32_t> NameIndex::Find(std::string_view name) const {
+  if (data_.ids.empty()) {
+    return std::nullopt;
+  }
+
+  const uint64_t hash = Hash(name, data_.seed);
+  return data_.ids[GetSlot(hash, data_.displacements[GetBucket(hash)])];
+}
+
+uint32_t NameIndex::GetNameCount() const {
+  return data_.name_count;
+}
+
+const NameIndex::NameIndexData &NameIndex::GetNameIndexData() const {
+  return data_;
+}
+
+// FNV-1a с перемешиванием результата: корзина и ячейка берутся из разных
+// битов одного хеша, поэтому имя при поиске хешируется один раз
+uint64_t NameIndex::Hash(std::string_view name, uint64_t seed) {
+  uint64_t hash = 0xcbf29ce484222325 ^ Mix(seed);
+  for (const char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return Mix(hash);
+}
+
+size_t NameIndex::GetBucket(uint64_t hash) const {
+  return (hash >> 32) % data_.displacements.size();
+}
+
+size_t NameIndex::GetSlot(uint64_t hash, uint32_t displacement) const {
+  return Mix(hash + (displacement + uint64_t{1}) * 0x9e3779b97f4a7c15)
+    % data_.ids.size();
+}
+
+// Корзины заполняются от больших к малым: большим корзинам проще подобрать
+// смещение, пока свободных ячеек много
+bool NameIndex::TryBuild(const std::vector<std::string_view> &names,
+  const std::vector<uint32_t> &ids) {
+  const size_t bucket_count = (ids.size() + BUCKET_SIZE - 1) / BUCKET_SIZE;
+  data_.displacements.assign(bucket_count, 0);
+  data_.ids.assign(ids.size(), 0);
+
+  std::vector<std::vector<std::pair<uint64_t, uint32_t>>> buckets(bucket_count);
+  for (const uint32_t id : ids) {
+    const uint64_t hash = Hash(names[id], data_.seed);
+    buckets[GetBucket(hash)].emplace_back(hash, id);
+  }
+
+  std::vector<size_t> bucket_order(bucket_count);
+  for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+    bucket_order[bucket] = bucket;
+  }
+  std::stable_sort(bucket_order.begin(), bucket_order.end(),
+    [&buckets](size_t lhs, size_t rhs) {
+      return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+  std::vector<bool> is_taken(ids.size(), false);
+  std::vector<size_t> slots;
+  for (const size_t bucket : bucket_order) {
+    const auto &keys = buckets[bucket];
+    if (keys.empty()) {
+      break;
+    }
+
+    uint32_t displacement = 0;
+    for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+      slots.clear();
+      for (const auto &[hash, id] : keys) {
+        const size_t slot = GetSlot(hash, displacement);
+        if (is_taken[slot]
+          || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+          break;
+        }
+        slots.push_back(slot);
+      }
+      if (slots.size() == keys.size()) {
+        break;
+      }
+    }
+    if (displacement == MAX_DISPLACEMENT) {
+      return false;
+    }
+
+    data_.displacements[bucket] = displacement;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      is_taken[slots[i]] = true;
+      data_.ids[slots[i]] = keys[i].second;
+    }
+  }
+  return true;
+}
+
+} // namespace tc
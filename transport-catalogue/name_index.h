@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace tc {
+
+// Минимальный совершенный хеш имён по схеме CHD. Хеш имени выбирает корзину,
+// смещение корзины - ячейку, в которой хранится номер имени. Смещения
+// подбираются при построении так, чтобы все имена набора попали в разные
+// ячейки. Имя вне набора тоже попадает в какую-то ячейку, поэтому имя с
+// найденным номером нужно сравнить с искомым
+class NameIndex {
+public:
+  struct NameIndexData {
+    uint64_t seed = 0;
+    uint32_t name_count = 0;
+    std::vector<uint32_t> displacements;  // По корзинам
+    std::vector<uint32_t> ids;            // По ячейкам
+  };
+
+  NameIndex() = default;
+
+  // Номером имени служит его позиция в names. Из повторяющихся имён
+  // сохраняется последнее
+  explicit NameIndex(const std::vector<std::string_view> &names);
+
+  // Восстанавливает индекс по сохранённым данным
+  explicit NameIndex(NameIndexData data);
+
+  // Номер-кандидат для имени или nullopt, если индекс пуст
+  std::optional<uint32_t> Find(std::string_view name) const;
+
+  // Имена с номерами меньше этого числа учтены индексом
+  uint32_t GetNameCount() const;
+
+  const NameIndexData &GetNameIndexData() const;
+
+private:
+  static uint64_t Hash(std::string_view name, uint64_t seed);
+  size_t GetBucket(uint64_t hash) const;
+  size_t GetSlot(uint64_t hash, uint32_t displacement) const;
+
+  bool TryBuild(const std::vector<std::string_view> &names,
+    const std::vector<uint32_t> &ids);
+
+  NameIndexData data_;
+};
+
+} // namespace tc
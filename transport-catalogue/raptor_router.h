@@ -0,0 +1,245 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Маршрутизатор, выполняющий поиск по раундам в духе RAPTOR. Вместо очереди с
+// приоритетом каждый раунд последовательно просматривает линии графа (маршруты
+// автобусов), проходящие через вершины, метки которых улучшились в предыдущем
+// раунде: один раунд соответствует одной посадке. Явные рёбра графа (ожидание
+// на остановке) рассматриваются как пересадки между раундами. Поиск
+// продолжается, пока метки улучшаются, поэтому находит кратчайший маршрут.
+// Предварительный расчёт не требуется
+template <typename Weight>
+class RaptorRouter : public BaseRouter<Weight> {
+private:
+  using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+  explicit RaptorRouter(const Graph& graph);
+
+  std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+  static constexpr EdgeId NO_EDGE = detail::SearchState<Weight>::NO_EDGE;
+
+  // Рабочие буферы раундов. Отметки вершин и линий, как и метки поиска,
+  // сбрасываются сменой номера раунда, а не очисткой массивов
+  struct ScanState {
+    detail::SearchState<Weight> labels;
+    std::vector<VertexId> marked;  // Вершины, улучшенные с прошлого раунда
+    std::vector<VertexId> transfers;
+    std::vector<uint32_t> vertex_rounds;
+    std::vector<size_t> marked_lines;
+    std::vector<size_t> line_first_positions;
+    std::vector<uint32_t> line_rounds;
+    uint32_t round = 0;
+
+    void Reset(size_t vertex_count, size_t line_count);
+    void NextRound();
+    void Mark(VertexId vertex);
+  };
+
+  static ScanState &GetScanState();
+
+  // Метка вершины улучшается и не хуже уже найденного маршрута до цели
+  static bool Improves(const ScanState &state, VertexId vertex, Weight weight,
+    VertexId target);
+
+  void RelaxTransfers(ScanState &state, VertexId target) const;
+  void CollectLines(ScanState &state) const;
+  void ScanLines(ScanState &state, VertexId target) const;
+
+  static constexpr Weight ZERO_WEIGHT{};
+  const Graph& graph_;
+};
+
+template <typename Weight>
+void RaptorRouter<Weight>::ScanState::Reset(size_t vertex_count,
+  size_t line_count) {
+  labels.Reset(vertex_count);
+  if (vertex_rounds.size() < vertex_count) {
+    vertex_rounds.resize(vertex_count, 0);
+  }
+  if (line_rounds.size() < line_count) {
+    line_rounds.resize(line_count, 0);
+    line_first_positions.resize(line_count);
+  }
+  marked.clear();
+  marked_lines.clear();
+  NextRound();
+}
+
+template <typename Weight>
+void RaptorRouter<Weight>::ScanState::NextRound() {
+  // При переполнении счётчика раундов отметки сбрасываются явно
+  if (++round == 0) {
+    std::fill(vertex_rounds.begin(), vertex_rounds.end(), 0);
+    std::fill(line_rounds.begin(), line_rounds.end(), 0);
+    round = 1;
+  }
+}
+
+template <typename Weight>
+void RaptorRouter<Weight>::ScanState::Mark(VertexId vertex) {
+  if (vertex_rounds[vertex] != round) {
+    vertex_rounds[vertex] = round;
+    marked.push_back(vertex);
+  }
+}
+
+template <typename Weight>
+RaptorRouter<Weight>::RaptorRouter(const Graph& graph)
+  : graph_(graph)
+{
+  for (const Weight weight : graph.GetEdgeWeights()) {
+    if (weight < ZERO_WEIGHT) {
+      throw std::domain_error("Edges' weights should be non-negative");
+    }
+  }
+}
+
+template <typename Weight>
+typename RaptorRouter<Weight>::ScanState &RaptorRouter<Weight>::GetScanState() {
+  static thread_local ScanState state;
+  return state;
+}
+
+template <typename Weight>
+bool RaptorRouter<Weight>::Improves(const ScanState &state, VertexId vertex,
+  Weight weight, VertexId target) {
+  const auto &labels = state.labels;
+  return (!labels.IsReached(vertex) || weight < labels.weights[vertex])
+    && (!labels.IsReached(target) || weight < labels.weights[target]);
+}
+
+// Распространяет улучшенные метки по явным рёбрам, пока они улучшаются.
+// Вершины, достигнутые пересадкой, отмечаются для посадки в следующем раунде
+template <typename Weight>
+void RaptorRouter<Weight>::RelaxTransfers(ScanState &state,
+  VertexId target) const {
+  auto &labels = state.labels;
+  state.transfers.assign(state.marked.begin(), state.marked.end());
+
+  while (!state.transfers.empty()) {
+    const VertexId vertex = state.transfers.back();
+    state.transfers.pop_back();
+
+    graph_.ForEachExplicitEdge(vertex,
+      [&](EdgeId edge_id, const Edge<Weight> &edge) {
+        const Weight weight = labels.weights[vertex] + edge.weight;
+        if (Improves(state, edge.to, weight, target)) {
+          labels.Label(edge.to, weight, edge_id);
+          state.Mark(edge.to);
+          state.transfers.push_back(edge.to);
+        }
+      });
+  }
+}
+
+// Выбирает линии, проходящие через отмеченные вершины, и для каждой линии
+// первую позицию, с которой её нужно просмотреть
+template <typename Weight>
+void RaptorRouter<Weight>::CollectLines(ScanState &state) const {
+  state.marked_lines.clear();
+  for (const VertexId vertex : state.marked) {
+    for (const auto [line, position] : graph_.GetLineStops(vertex)) {
+      if (state.line_rounds[line] != state.round) {
+        state.line_rounds[line] = state.round;
+        state.line_first_positions[line] = position;
+        state.marked_lines.push_back(line);
+      } else {
+        state.line_first_positions[line] =
+          std::min(state.line_first_positions[line], position);
+      }
+    }
+  }
+  state.marked.clear();
+  state.NextRound();
+}
+
+// Проходит каждую выбранную линию один раз, запоминая лучшую позицию посадки.
+// Пересесть на ту же линию позже выгодно, только если метка вершины посадки
+// меньше времени, за которое до неё можно доехать с текущей посадки
+template <typename Weight>
+void RaptorRouter<Weight>::ScanLines(ScanState &state, VertexId target) const {
+  auto &labels = state.labels;
+
+  for (const size_t line_id : state.marked_lines) {
+    const auto &line = graph_.GetLines()[line_id];
+    std::optional<size_t> boarding;
+    Weight boarding_weight = ZERO_WEIGHT;
+
+    for (size_t position = state.line_first_positions[line_id];
+      position < line.GetSize(); ++position) {
+      std::optional<Weight> ride_weight;
+      if (boarding) {
+        ride_weight = boarding_weight
+          + graph_.GetLineEdgeWeight(line_id, *boarding, position);
+
+        const VertexId vertex = line.to[position];
+        if (Improves(state, vertex, *ride_weight, target)) {
+          labels.Label(vertex, *ride_weight,
+            graph_.GetLineEdgeId(line_id, *boarding, position));
+          state.Mark(vertex);
+        }
+      }
+
+      const VertexId stop = line.from[position];
+      if (position + 1 < line.GetSize() && labels.IsReached(stop)
+        && (!ride_weight || labels.weights[stop] < *ride_weight)) {
+        boarding = position;
+        boarding_weight = labels.weights[stop];
+      }
+    }
+  }
+}
+
+template <typename Weight>
+std::optional<typename RaptorRouter<Weight>::RouteInfo>
+RaptorRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+  const size_t vertex_count = graph_.GetVertexCount();
+  if (from >= vertex_count || to >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  auto &state = GetScanState();
+  state.Reset(vertex_count, graph_.GetLines().size());
+  state.labels.Label(from, ZERO_WEIGHT, NO_EDGE);
+  state.Mark(from);
+
+  while (!state.marked.empty()) {
+    RelaxTransfers(state, to);
+    CollectLines(state);
+    ScanLines(state, to);
+  }
+
+  const auto &labels = state.labels;
+  if (!labels.IsReached(to)) {
+    return std::nullopt;
+  }
+
+  std::vector<EdgeId> edges;
+  for (EdgeId edge_id = labels.prev_edges[to]; edge_id != NO_EDGE;
+    edge_id = labels.prev_edges[graph_.GetEdge(edge_id).from]) {
+    edges.push_back(edge_id);
+  }
+  std::reverse(edges.begin(), edges.end());
+
+  return RouteInfo{labels.weights[to], std::move(edges)};
+}
+
+}  // namespace graph
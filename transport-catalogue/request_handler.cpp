@@ -3,46 +3,153 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <utility>
+
 namespace tc {
 
 RequestHandler::RequestHandler(const TransportCatalogue& db,
-  const renderer::MapRenderer& renderer, const router::TransportRouter& router)
+  const renderer::MapRenderer& renderer, router::TransportRouter& router)
   : db_(db), renderer_(renderer), router_(router) {}
 
 std::optional<BusInfo>
 RequestHandler::GetBusInfo(const std::string_view &bus_name) const {
   auto bus = db_.GetBus(bus_name);
 
-  return bus ? std::make_optional(db_.GetBusInfo(bus)) : std::nullopt;
+  return bus ? std::make_optional(db_.GetBusInfo(bus->id)) : std::nullopt;
 }
 
 const Buses *
 RequestHandler::GetBusesByStop(const std::string_view &stop_name) const {
   auto stop = db_.GetStop(stop_name);
 
-  return stop ? &(db_.GetBusesByStop(stop->name)) : nullptr;
+  return stop ? &(db_.GetBusesByStop(stop->id)) : nullptr;
+}
+
+std::vector<const Stop *>
+RequestHandler::SearchStops(std::string_view query, size_t limit) const {
+  std::vector<const Stop *> stops;
+
+  for (const StopId id : db_.GetStopSearch().Find(query, limit)) {
+    stops.push_back(&db_.GetStop(id));
+  }
+
+  return stops;
+}
+
+std::vector<std::pair<const Stop *, double>>
+RequestHandler::FindNearestStops(geo::Coordinates coordinates, double radius,
+  size_t count) const {
+  std::vector<std::pair<const Stop *, double>> stops;
+
+  for (const auto &[id, distance] :
+    db_.GetSpatialIndex().FindNearest(coordinates, radius, count)) {
+    stops.emplace_back(&db_.GetStop(id), distance);
+  }
+
+  return stops;
 }
 
 svg::Document RequestHandler::RenderMap() const {
   svg::Document doc;
-  auto buses = db_.GetBuses();
-
-  renderer_.RenderMap(buses.begin(), buses.end()).Draw(doc);
+  renderer_.RenderMap(db_).Draw(doc);
 
   return doc;
 }
 
 std::optional<router::RouteInfo>
 RequestHandler::FindRoute(std::string_view stop_name_from,
-  std::string_view stop_name_to) const {
+  std::string_view stop_name_to,
+  const router::RoutingOverrides &overrides) const {
   const Stop *from = db_.GetStop(stop_name_from);
   const Stop *to = db_.GetStop(stop_name_to);
 
   if (from != nullptr && to != nullptr) {
-    return router_.FindRoute(from, to);
+    return router_.FindRoute(from, to, overrides);
   } else {
     return std::nullopt;
   }
 }
 
+std::optional<double>
+RequestHandler::FindRouteTime(std::string_view stop_name_from,
+  std::string_view stop_name_to,
+  const router::RoutingOverrides &overrides) const {
+  const Stop *from = db_.GetStop(stop_name_from);
+  const Stop *to = db_.GetStop(stop_name_to);
+
+  if (from != nullptr && to != nullptr) {
+    const auto total_time = router_.FindRouteTime(from, to, overrides);
+    if (total_time.has_value()) {
+      return total_time->count();
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::vector<router::ReachableStop>>
+RequestHandler::FindReachableStops(std::string_view stop_name_from,
+  double max_minutes, const router::RoutingOverrides &overrides) const {
+  const Stop *from = db_.GetStop(stop_name_from);
+
+  if (from != nullptr) {
+    return router_.FindReachableStops(from, router::Minutes(max_minutes),
+      overrides);
+  } else {
+    return std::nullopt;
+  }
+}
+
+std::optional<router::RouteMatrix>
+RequestHandler::FindRouteMatrix(
+  const std::vector<std::string_view> &stop_names_from,
+  const std::vector<std::string_view> &stop_names_to,
+  const router::RoutingOverrides &overrides) const {
+  auto find_stops = [this](const std::vector<std::string_view> &names) {
+    std::vector<const Stop *> stops;
+    stops.reserve(names.size());
+    for (const auto name : names) {
+      const Stop *stop = db_.GetStop(name);
+      if (stop == nullptr) {
+        return std::optional<std::vector<const Stop *>>{};
+      }
+      stops.push_back(stop);
+    }
+    return std::make_optional(std::move(stops));
+  };
+
+  const auto from = find_stops(stop_names_from);
+  const auto to = find_stops(stop_names_to);
+  if (from && to) {
+    return router_.FindRouteMatrix(*from, *to, overrides);
+  } else {
+    return std::nullopt;
+  }
+}
+
+bool RequestHandler::SetClosures(const std::vector<std::string_view> &stop_names,
+  const std::vector<std::string_view> &bus_names) {
+  router::Closures closures;
+  for (const auto name : stop_names) {
+    const Stop *stop = db_.GetStop(name);
+    if (stop == nullptr) {
+      return false;
+    }
+    closures.stops.insert(stop);
+  }
+  for (const auto name : bus_names) {
+    const Bus *bus = db_.GetBus(name);
+    if (bus == nullptr) {
+      return false;
+    }
+    closures.buses.insert(bus);
+  }
+
+  router_.SetClosures(std::move(closures));
+  return true;
+}
+
+void RequestHandler::ClearClosures() {
+  router_.ClearClosures();
+}
+
 } // namespace tc
\ No newline at end of file
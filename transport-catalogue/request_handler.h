@@ -3,6 +3,8 @@
 #include <optional>
 #include <string_view>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace svg {
 class Document;
@@ -16,6 +18,9 @@ class MapRenderer;
 
 namespace router {
 struct RouteInfo;
+struct RouteMatrix;
+struct ReachableStop;
+struct RoutingOverrides;
 class TransportRouter;
 } // namespace router
 
@@ -23,7 +28,7 @@ class RequestHandler {
 public:
   RequestHandler(const TransportCatalogue& db,
     const renderer::MapRenderer &renderer,
-    const router::TransportRouter &router);
+    router::TransportRouter &router);
 
   // Возвращает информацию о маршруте (запрос Bus)
   [[nodiscard]] std::optional<BusInfo>
@@ -33,18 +38,58 @@ public:
   [[nodiscard]] const Buses *
   GetBusesByStop(const std::string_view &stop_name) const;
 
+  // Возвращает не более limit остановок, название которых или слово в нём
+  // начинается с запроса (запрос StopSearch)
+  [[nodiscard]] std::vector<const Stop *>
+  SearchStops(std::string_view query, size_t limit) const;
+
+  // Возвращает не более count ближайших к точке остановок не дальше radius
+  // метров и расстояния до них (запрос NearestStops)
+  [[nodiscard]] std::vector<std::pair<const Stop *, double>>
+  FindNearestStops(geo::Coordinates coordinates, double radius,
+    size_t count) const;
+
   // Рендерит карту маршрутов
   [[nodiscard]] svg::Document RenderMap() const;
 
-  // Возвращает описание маршрута
+  // Возвращает описание маршрута. Переопределения параметров маршрутизации
+  // действуют только для этого запроса
   [[nodiscard]] std::optional<router::RouteInfo>
-  FindRoute(std::string_view stop_from, std::string_view stop_to) const;
+  FindRoute(std::string_view stop_from, std::string_view stop_to,
+    const router::RoutingOverrides &overrides) const;
+
+  // Возвращает время в пути в минутах без описания маршрута (запрос Route с
+  // total_time_only)
+  [[nodiscard]] std::optional<double>
+  FindRouteTime(std::string_view stop_from, std::string_view stop_to,
+    const router::RoutingOverrides &overrides) const;
+
+  // Возвращает остановки, достижимые за max_minutes (запрос Reachable), или
+  // nullopt, если начальная остановка не найдена
+  [[nodiscard]] std::optional<std::vector<router::ReachableStop>>
+  FindReachableStops(std::string_view stop_from, double max_minutes,
+    const router::RoutingOverrides &overrides) const;
+
+  // Возвращает матрицу времени в пути между остановками (запрос RouteMatrix)
+  // или nullopt, если какая-либо остановка не найдена
+  [[nodiscard]] std::optional<router::RouteMatrix>
+  FindRouteMatrix(const std::vector<std::string_view> &stops_from,
+    const std::vector<std::string_view> &stops_to,
+    const router::RoutingOverrides &overrides) const;
+
+  // Закрывает остановки и автобусы для последующих запросов маршрутов
+  // (запрос SetClosures), заменяя прежние закрытия. Возвращает false и не
+  // меняет закрытия, если какая-либо остановка или автобус не найдены
+  bool SetClosures(const std::vector<std::string_view> &stop_names,
+    const std::vector<std::string_view> &bus_names);
 
+  // Снимает все закрытия (запрос ClearClosures)
+  void ClearClosures();
 
 private:
   const TransportCatalogue &db_;
   const renderer::MapRenderer &renderer_;
-  const router::TransportRouter &router_;
+  router::TransportRouter &router_;
 };
 
 }  // namespace tc
@@ -4,118 +4,312 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+namespace detail {
+
+// Выбор значения без ветвления, позволяющий компилятору векторизовать цикл
+template <typename T>
+T Select(bool condition, T lhs, T rhs) {
+  return condition ? lhs : rhs;
+}
+
+template <typename Rep, typename Period>
+std::chrono::duration<Rep, Period> Select(bool condition,
+  std::chrono::duration<Rep, Period> lhs,
+  std::chrono::duration<Rep, Period> rhs) {
+  return std::chrono::duration<Rep, Period>(
+    condition ? lhs.count() : rhs.count());
+}
+
+// Барьер синхронизации фиксированного числа потоков
+class Barrier {
+public:
+  explicit Barrier(size_t thread_count) : thread_count_(thread_count) {}
+
+  void ArriveAndWait() {
+    std::unique_lock lock(mutex_);
+    const size_t generation = generation_;
+    if (++arrived_ == thread_count_) {
+      arrived_ = 0;
+      ++generation_;
+      condition_.notify_all();
+    } else {
+      condition_.wait(lock, [this, generation] {
+        return generation != generation_;
+      });
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  const size_t thread_count_;
+  size_t arrived_ = 0;
+  size_t generation_ = 0;
+};
+
+}  // namespace detail
+
 template <typename Weight>
-class Router {
+struct RouteInfo {
+  Weight weight;
+  std::vector<EdgeId> edges;
+};
+
+// Общий интерфейс движков поиска кратчайшего пути в графе
+template <typename Weight>
+class BaseRouter {
+public:
+  using RouteInfo = graph::RouteInfo<Weight>;
+
+  virtual ~BaseRouter() = default;
+
+  virtual std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const = 0;
+};
+
+// Маршрутизатор с предварительным расчётом кратчайших путей между всеми парами
+// вершин. Требует O(V^2) памяти и O(V^3) времени на построение. Расчёт может
+// выполняться в нескольких потоках: на каждой итерации по промежуточной вершине
+// строки матрицы независимы, поэтому результат не зависит от числа потоков
+template <typename Weight>
+class Router : public BaseRouter<Weight> {
 private:
   using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-  explicit Router(const Graph& graph);
+  using RouteInfo = typename BaseRouter<Weight>::RouteInfo;
+
+  // Особые значения предыдущего ребра: маршрута нет вовсе, либо маршрут пуст
+  static constexpr uint32_t NO_ROUTE = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t NO_PREV_EDGE = NO_ROUTE - 1;
 
-  struct RouteInfo {
-    Weight weight;
-    std::vector<EdgeId> edges;
+  // Матрица кратчайших путей V x V, хранящаяся построчно в двух непрерывных
+  // массивах: веса маршрутов и последние рёбра маршрутов
+  struct RoutesInternalData {
+    size_t vertex_count = 0;
+    std::vector<Weight> weights;
+    std::vector<uint32_t> prev_edges;
   };
 
-  std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+  explicit Router(const Graph& graph, size_t thread_count = 1);
+
+  // Восстанавливает маршрутизатор по ранее рассчитанным данным без повторного
+  // расчёта кратчайших путей
+  Router(const Graph& graph, RoutesInternalData routes_internal_data);
+
+  std::optional<RouteInfo>
+  BuildRoute(VertexId from, VertexId to) const override;
+
+  const RoutesInternalData &GetRoutesInternalData() const;
+
+  // Объём памяти таблицы кратчайших путей для графа, в байтах
+  static size_t EstimateMemoryUsage(const Graph& graph);
 
 private:
-  struct RouteInternalData {
-    Weight weight;
-    std::optional<EdgeId> prev_edge;
-  };
-  using RoutesInternalData =
-  std::vector<std::vector<std::optional<RouteInternalData>>>;
+  size_t GetIndex(VertexId from, VertexId to) const {
+    return from * routes_internal_data_.vertex_count + to;
+  }
 
   void InitializeRoutesInternalData(const Graph& graph) {
     const size_t vertex_count = graph.GetVertexCount();
+    if (graph.GetEdgeCount() >= NO_PREV_EDGE) {
+      throw std::overflow_error("Too many edges for the routes matrix");
+    }
+
+    auto &weights = routes_internal_data_.weights;
+    auto &prev_edges = routes_internal_data_.prev_edges;
     for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-      routes_internal_data_[vertex][vertex] =
-        RouteInternalData{ZERO_WEIGHT, std::nullopt};
-      for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-        const auto& edge = graph.GetEdge(edge_id);
-        if (edge.weight < ZERO_WEIGHT) {
-          throw std::domain_error("Edges' weights should be non-negative");
-        }
-        auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-        if (!route_internal_data
-          || route_internal_data->weight > edge.weight) {
-          route_internal_data = RouteInternalData{edge.weight, edge_id};
+      weights[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
+      prev_edges[GetIndex(vertex, vertex)] = NO_PREV_EDGE;
+      graph.ForEachIncidentEdge(vertex,
+        [&, vertex](EdgeId edge_id, const Edge<Weight>& edge) {
+          if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+          }
+          const size_t index = GetIndex(vertex, edge.to);
+          if (prev_edges[index] == NO_ROUTE || weights[index] > edge.weight) {
+            weights[index] = edge.weight;
+            prev_edges[index] = static_cast<uint32_t>(edge_id);
+          }
+        });
+    }
+  }
+
+  // Релаксирует строки матрицы с first_row с шагом row_step через вершину
+  // vertex_through. Столбцы обрабатываются блоками, чтобы блок строки
+  // vertex_through оставался в кэше при проходе по всем строкам потока.
+  // Строка и столбец vertex_through на этой итерации не меняются, поэтому
+  // строки можно обрабатывать параллельно
+  void RelaxRoutesInternalDataThroughVertex(size_t vertex_count,
+    VertexId vertex_through, VertexId first_row = 0, size_t row_step = 1) {
+    Weight *weights = routes_internal_data_.weights.data();
+    uint32_t *prev_edges = routes_internal_data_.prev_edges.data();
+    const Weight *weights_through = weights + GetIndex(vertex_through, 0);
+    const uint32_t *prev_edges_through =
+      prev_edges + GetIndex(vertex_through, 0);
+
+    for (VertexId block_begin = 0; block_begin < vertex_count;
+      block_begin += COLUMN_BLOCK_SIZE) {
+      const VertexId block_end =
+        std::min(block_begin + COLUMN_BLOCK_SIZE, vertex_count);
+
+      for (VertexId vertex_from = first_row; vertex_from < vertex_count;
+        vertex_from += row_step) {
+        const size_t index_from = GetIndex(vertex_from, vertex_through);
+        if (vertex_from == vertex_through
+          || prev_edges[index_from] == NO_ROUTE) {
+          continue;
         }
+        RelaxRow(weights + GetIndex(vertex_from, 0),
+          prev_edges + GetIndex(vertex_from, 0), weights_through,
+          prev_edges_through, block_begin, block_end, weights[index_from],
+          prev_edges[index_from]);
       }
     }
   }
 
-  void RelaxRoute(VertexId vertex_from, VertexId vertex_to,
-    const RouteInternalData& route_from, const RouteInternalData& route_to) {
-    auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-    const Weight candidate_weight = route_from.weight + route_to.weight;
-    if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-      route_relaxing = {candidate_weight,
-        route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+  // Внутренний цикл без ветвлений: поэлементный минимум строки и суммы
+  // маршрута до промежуточной вершины со строкой промежуточной вершины
+  static void RelaxRow(Weight *weights_row, uint32_t *prev_edges_row,
+    const Weight *weights_through, const uint32_t *prev_edges_through,
+    VertexId block_begin, VertexId block_end, Weight weight_from,
+    uint32_t prev_edge_from) {
+    for (VertexId vertex_to = block_begin; vertex_to < block_end;
+      ++vertex_to) {
+      const uint32_t prev_edge_to = prev_edges_through[vertex_to];
+      const uint32_t prev_edge = prev_edges_row[vertex_to];
+      const Weight weight = weights_row[vertex_to];
+      const Weight candidate_weight = weight_from + weights_through[vertex_to];
+      const bool is_better = (prev_edge_to != NO_ROUTE)
+        & ((prev_edge == NO_ROUTE) | (candidate_weight < weight));
+
+      weights_row[vertex_to] =
+        detail::Select(is_better, candidate_weight, weight);
+      prev_edges_row[vertex_to] = detail::Select(is_better,
+        detail::Select(prev_edge_to != NO_PREV_EDGE,
+          prev_edge_to, prev_edge_from),
+        prev_edge);
     }
   }
 
-  void RelaxRoutesInternalDataThroughVertex(size_t vertex_count,
-    VertexId vertex_through) {
-    for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-      if (const auto& route_from =
-        routes_internal_data_[vertex_from][vertex_through]) {
-        for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-          if (const auto& route_to =
-            routes_internal_data_[vertex_through][vertex_to]) {
-            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-          }
-        }
+  void RelaxRoutesInternalData(size_t vertex_count, size_t thread_count) {
+    if (thread_count <= 1) {
+      for (VertexId vertex_through = 0;
+        vertex_through < vertex_count; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
       }
+      return;
+    }
+
+    // Строки распределяются между потоками через одну для равномерной
+    // загрузки. Перед переходом к следующей промежуточной вершине потоки
+    // дожидаются друг друга
+    detail::Barrier barrier(thread_count);
+    auto relax_rows = [this, vertex_count, thread_count, &barrier](
+      VertexId first_row) {
+      for (VertexId vertex_through = 0;
+        vertex_through < vertex_count; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through,
+          first_row, thread_count);
+        barrier.ArriveAndWait();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    for (VertexId first_row = 1; first_row < thread_count; ++first_row) {
+      workers.emplace_back(relax_rows, first_row);
+    }
+    relax_rows(0);
+    for (auto &worker : workers) {
+      worker.join();
     }
   }
 
+  // Число столбцов в блоке: около 48 КиБ данных строки промежуточной вершины
+  static constexpr size_t COLUMN_BLOCK_SIZE = 4096;
   static constexpr Weight ZERO_WEIGHT{};
   const Graph& graph_;
   RoutesInternalData routes_internal_data_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+size_t Router<Weight>::EstimateMemoryUsage(const Graph& graph) {
+  const size_t vertex_count = graph.GetVertexCount();
+  return vertex_count * vertex_count * (sizeof(Weight) + sizeof(uint32_t));
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, size_t thread_count)
   : graph_(graph)
-  , routes_internal_data_(graph.GetVertexCount(),
-    std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+  , routes_internal_data_{graph.GetVertexCount(),
+    std::vector<Weight>(graph.GetVertexCount() * graph.GetVertexCount()),
+    std::vector<uint32_t>(graph.GetVertexCount() * graph.GetVertexCount(),
+      NO_ROUTE)}
 {
   InitializeRoutesInternalData(graph);
 
   const size_t vertex_count = graph.GetVertexCount();
-  for (VertexId vertex_through = 0;
-    vertex_through < vertex_count; ++vertex_through) {
-    RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+  RelaxRoutesInternalData(vertex_count,
+    std::min(thread_count, std::max<size_t>(vertex_count, 1)));
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph,
+  RoutesInternalData routes_internal_data)
+  : graph_(graph)
+  , routes_internal_data_(std::move(routes_internal_data))
+{
+  const size_t vertex_count = graph.GetVertexCount();
+  const size_t cell_count = vertex_count * vertex_count;
+  if (routes_internal_data_.vertex_count != vertex_count
+    || routes_internal_data_.weights.size() != cell_count
+    || routes_internal_data_.prev_edges.size() != cell_count) {
+    throw std::invalid_argument("Routes data doesn't match the graph");
   }
 }
 
+template <typename Weight>
+const typename Router<Weight>::RoutesInternalData &
+Router<Weight>::GetRoutesInternalData() const {
+  return routes_internal_data_;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo>
 Router<Weight>::BuildRoute(VertexId from, VertexId to) const {
-  const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-  if (!route_internal_data) {
+  const size_t vertex_count = routes_internal_data_.vertex_count;
+  if (from >= vertex_count || to >= vertex_count) {
+    throw std::out_of_range("Vertex id is out of range");
+  }
+
+  const auto &prev_edges = routes_internal_data_.prev_edges;
+  const size_t index = GetIndex(from, to);
+  if (prev_edges[index] == NO_ROUTE) {
     return std::nullopt;
   }
-  const Weight weight = route_internal_data->weight;
+  const Weight weight = routes_internal_data_.weights[index];
   std::vector<EdgeId> edges;
-  for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-    edge_id;
-    edge_id =
-      routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+  for (uint32_t edge_id = prev_edges[index];
+    edge_id != NO_PREV_EDGE;
+    edge_id = prev_edges[GetIndex(from, graph_.GetEdge(edge_id).from)])
   {
-    edges.push_back(*edge_id);
+    edges.push_back(edge_id);
   }
   std::reverse(edges.begin(), edges.end());
 
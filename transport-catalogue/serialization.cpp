@@ -4,7 +4,12 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <cstdint>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
 #include <variant>
 
 #include <transport_catalogue.pb.h>
@@ -68,19 +73,16 @@ static void SerializeStops(const TransportCatalogue &cat,
     transport_catalogue::TransportCatalogue &serial) {
   for (const auto &stop : cat.GetStops()) {
     auto s_stop = serial.add_stop();
+    const auto coordinates = cat.GetCoordinates(stop.id);
 
     s_stop->set_name(stop.name);
-    s_stop->set_latitude(stop.lat);
-    s_stop->set_longitude(stop.lng);
-
-    for (const auto &[stops, d] : cat.GetDistances()) {
-      if (stop.name != stops.first->name) {
-        continue;
-      }
+    s_stop->set_latitude(coordinates.lat);
+    s_stop->set_longitude(coordinates.lng);
 
+    for (const auto &[to, distance] : cat.GetDistancesFrom(stop.id)) {
       auto s_dist = s_stop->add_road_distances();
-      s_dist->set_name(stops.second->name);
-      s_dist->set_distance(d);
+      s_dist->set_stop_id(to);
+      s_dist->set_distance(distance);
     }
   }
 }
@@ -89,27 +91,57 @@ static void SerializeBuses(const TransportCatalogue &cat,
     transport_catalogue::TransportCatalogue &serial) {
   for (const auto &bus : cat.GetBuses()) {
     auto s_bus = serial.add_bus();
-    auto stops_unique_count = bus.stops.size();
-    auto final_stops_count = bus.final_stops.size();
+    const auto route = cat.GetRoute(bus.id);
 
     s_bus->set_name(bus.name);
+    s_bus->set_is_roundtrip(bus.is_roundtrip);
 
-    // Определение кольцевого маршрута
-    if (final_stops_count == 1) {
-      s_bus->set_is_roundtrip(true);
-    } else {
-      s_bus->set_is_roundtrip(false);
+    // В случае, когда маршрут НЕ кольцевой, обратный путь не учитывается
+    const size_t stop_count = bus.is_roundtrip
+      ? bus.route_size : (bus.route_size + 1) / 2;
+    s_bus->mutable_stop_id()->Add(route.begin(), route.begin() + stop_count);
+  }
+}
 
-      // В случае, когда маршрут НЕ кольцевой, обратный путь не учитывается
-      stops_unique_count = (stops_unique_count / final_stops_count)
-        + (stops_unique_count % final_stops_count);
-    }
+static void SerializeNameIndex(const NameIndex &index,
+    transport_catalogue::NameIndex *s_index) {
+  const auto &data = index.GetNameIndexData();
 
-    for (int i = 0; i < stops_unique_count; ++i) {
-      s_bus->add_stop(bus.stops[i]->name);
-    }
+  s_index->set_seed(data.seed);
+  s_index->set_name_count(data.name_count);
+  s_index->mutable_displacement()->Add(data.displacements.begin(),
+    data.displacements.end());
+  s_index->mutable_id()->Add(data.ids.begin(), data.ids.end());
+}
+
+static void SerializeNameIndexes(const TransportCatalogue &cat,
+    transport_catalogue::TransportCatalogue &serial) {
+  SerializeNameIndex(cat.GetStopNameIndex(),
+    serial.mutable_stop_name_index());
+  SerializeNameIndex(cat.GetBusNameIndex(), serial.mutable_bus_name_index());
+}
+
+static void SerializeStopSearch(const TransportCatalogue &cat,
+    transport_catalogue::TransportCatalogue &serial) {
+  const auto &data = cat.GetStopSearch().GetStopSearchData();
+  auto s_stop_search = serial.mutable_stop_search();
+
+  s_stop_search->mutable_stop()->Add(data.stops.begin(), data.stops.end());
+  for (const auto &[stop, offset] : data.words) {
+    s_stop_search->add_word_stop(stop);
+    s_stop_search->add_word_offset(offset);
   }
 }
+
+static void SerializeSpatialIndex(const TransportCatalogue &cat,
+    transport_catalogue::TransportCatalogue &serial) {
+  const auto &data = cat.GetSpatialIndex().GetSpatialIndexData();
+  auto s_spatial_index = serial.mutable_spatial_index();
+
+  s_spatial_index->mutable_stop()->Add(data.stops.begin(), data.stops.end());
+  s_spatial_index->mutable_axis()->Add(data.axes.begin(), data.axes.end());
+}
+
 static void SerializeRenderSettings(const renderer::RenderSettings &rs,
     transport_catalogue::TransportCatalogue &serial) {
   auto mutable_rs = serial.mutable_render_settings();
@@ -158,6 +190,13 @@ static void SerializeRoutingSettings(const router::RoutingSettings &ros,
 
   mutable_ros->set_bus_wait_time(ros.bus_wait_time.count());
   mutable_ros->set_bus_velocity(ros.bus_velocity);
+  mutable_ros->set_router_type(static_cast<uint32_t>(ros.router_type));
+  mutable_ros->set_thread_count(ros.thread_count);
+  mutable_ros->set_landmark_count(ros.landmark_count);
+  mutable_ros->set_route_cache_capacity(ros.route_cache_capacity);
+  mutable_ros->set_vertex_order(static_cast<uint32_t>(ros.vertex_order));
+  mutable_ros->set_hub_labels(ros.hub_labels);
+  mutable_ros->set_memory_budget(ros.memory_budget);
 }
 
 static void
@@ -165,33 +204,38 @@ SerializeGraph(const graph::DirectedWeightedGraph<router::Minutes> &graph,
     transport_catalogue::TransportCatalogue &serial) {
   auto mutable_graph = serial.mutable_router()->mutable_graph();
 
-  for (size_t i = 0; i < graph.GetEdgeCount(); ++i) {
-    auto s_edge = mutable_graph->add_edge();
-    auto cur_edge = graph.GetEdge(i);
-
-    s_edge->set_from(cur_edge.from);
-    s_edge->set_to(cur_edge.to);
-    s_edge->set_weight(cur_edge.weight.count());
+  // Сохраняются только явные рёбра, рёбра линий восстанавливаются по линиям
+  const auto &offsets = graph.GetEdgeOffsets();
+  const auto &targets = graph.GetEdgeTargets();
+  mutable_graph->mutable_edge_offset()->Add(offsets.begin(), offsets.end());
+  mutable_graph->mutable_edge_target()->Add(targets.begin(), targets.end());
+  mutable_graph->mutable_edge_weight()->Reserve(
+    static_cast<int>(graph.GetEdgeWeights().size()));
+  for (const auto &weight : graph.GetEdgeWeights()) {
+    mutable_graph->mutable_edge_weight()->AddAlreadyReserved(weight.count());
   }
 
-  for (size_t i = 0; i < graph.GetVertexCount(); ++i) {
-    auto s_ilist = mutable_graph->add_incidence_list();
-    auto edges_range = graph.GetIncidentEdges(i);
+  for (const auto &line : graph.GetLines()) {
+    auto s_line = mutable_graph->add_line();
 
-    for (const auto &edge_id : edges_range) {
-      s_ilist->add_edge_id(edge_id);
-    }
+    s_line->mutable_from()->Add(line.from.begin(), line.from.end());
+    s_line->mutable_to()->Add(line.to.begin(), line.to.end());
+    s_line->mutable_length()->Add(line.lengths.begin(), line.lengths.end());
   }
+  mutable_graph->set_line_speed(graph.GetWeightParameters().line_speed);
+  mutable_graph->set_explicit_weight_scale(
+    graph.GetWeightParameters().explicit_weight_scale);
 }
 
 static void
-SerializeStopVertexIds(const std::unordered_map<const Stop *,
-  router::TransportRouter::StopVertexIds, Hasher> &stops_vertex_ids,
+SerializeStopVertexIds(
+    const std::vector<router::TransportRouter::StopVertexIds> &stops_vertex_ids,
     transport_catalogue::TransportCatalogue &serial) {
-  for (const auto &[key, val] : stops_vertex_ids) {
+  for (StopId stop_id = 0; stop_id < stops_vertex_ids.size(); ++stop_id) {
+    const auto &val = stops_vertex_ids[stop_id];
     auto s_svid = serial.mutable_router()->add_stops_vertex_id();
 
-    s_svid->set_stop_name(key->name);
+    s_svid->set_stop_id(stop_id);
     s_svid->mutable_id()->set_in(val.in);
     s_svid->mutable_id()->set_out(val.out);
   }
@@ -201,7 +245,7 @@ static void
 SerializeVertexes(const std::vector<const Stop *> &vertexes,
     transport_catalogue::TransportCatalogue &serial) {
   for (const auto &v : vertexes) {
-    serial.mutable_router()->add_vertex()->set_stop_name(v->name);
+    serial.mutable_router()->add_vertex()->set_stop_id(v->id);
   }
 }
 
@@ -212,7 +256,7 @@ SerializeEdges(const std::vector<router::TransportRouter::EdgeInfo> &edges,
     auto s_edge = serial.mutable_router()->add_edge();
 
     if (edge.has_value()) {
-      s_edge->mutable_bus_edge()->set_bus_name(edge->bus->name);
+      s_edge->mutable_bus_edge()->set_bus_id(edge->bus->id);
       s_edge->mutable_bus_edge()->set_span_count(edge->span_count);
     } else {
       s_edge->set_nullopt(true);
@@ -220,60 +264,207 @@ SerializeEdges(const std::vector<router::TransportRouter::EdgeInfo> &edges,
   }
 }
 
+static void SerializeLineBuses(const std::vector<const Bus *> &line_buses,
+    transport_catalogue::TransportCatalogue &serial) {
+  for (const auto *bus : line_buses) {
+    serial.mutable_router()->add_line_bus_id(bus->id);
+  }
+}
 
-static void DeserializeStops(TransportCatalogue &cat,
-    const transport_catalogue::TransportCatalogue &serial) {
-  std::map<std::string, std::map<std::string, int>> distances;
+static void SerializeCoveredLines(
+    const std::vector<router::TransportRouter::CoveredLine> &covered_lines,
+    transport_catalogue::TransportCatalogue &serial) {
+  for (const auto &[bus, line, begin, end] : covered_lines) {
+    auto *s_covered_line = serial.mutable_router()->add_covered_line();
+    s_covered_line->set_bus_id(bus->id);
+    s_covered_line->set_line(static_cast<uint32_t>(line));
+    s_covered_line->set_begin(static_cast<uint32_t>(begin));
+    s_covered_line->set_end(static_cast<uint32_t>(end));
+  }
+}
 
-  for (int i = 0; i < serial.stop_size(); ++i) {
-    Stop stop;
+// Наибольший размер сообщения protobuf: сообщения больше 2 ГБ не
+// сериализуются
+static const size_t MAX_MESSAGE_SIZE = std::numeric_limits<int>::max();
 
-    stop.name = serial.stop(i).name();
-    stop.lat = serial.stop(i).latitude();
-    stop.lng = serial.stop(i).longitude();
-    cat.AddStop(stop);
+// Наибольший размер ячейки таблицы кратчайших путей: вес типа double и номер
+// ребра в кодировке varint
+static const size_t MAX_CELL_SIZE = sizeof(double) + 5;
 
-    for (int j = 0; j < serial.stop(i).road_distances_size(); ++j) {
-      distances[stop.name][serial.stop(i).road_distances(j).name()]
-        = static_cast<int>(serial.stop(i).road_distances(j).distance());
-    }
+static void SerializeRoutesInternalData(
+    const graph::BaseRouter<router::Minutes> &router,
+    transport_catalogue::TransportCatalogue &serial) {
+  const auto all_pairs_router =
+    dynamic_cast<const graph::Router<router::Minutes> *>(&router);
+
+  // Таблица кратчайших путей есть только у маршрутизатора, рассчитывающего
+  // все пары вершин
+  if (all_pairs_router == nullptr) {
+    return;
+  }
+
+  const auto &routes = all_pairs_router->GetRoutesInternalData();
+
+  // Таблица занимает до MAX_CELL_SIZE байт на ячейку. Если она не помещается
+  // в сообщение protobuf, база сохраняется без неё, а таблица рассчитывается
+  // заново при загрузке
+  const size_t cell_count = routes.weights.size();
+  if (cell_count > MAX_MESSAGE_SIZE / MAX_CELL_SIZE) {
+    return;
+  }
+
+  auto s_routes = serial.mutable_router()->mutable_routes_internal_data();
+  auto s_weights = s_routes->mutable_weight();
+
+  s_weights->Reserve(static_cast<int>(routes.weights.size()));
+  for (const auto weight : routes.weights) {
+    s_weights->AddAlreadyReserved(weight.count());
   }
+  s_routes->mutable_prev_edge()->Add(routes.prev_edges.begin(),
+    routes.prev_edges.end());
+}
 
-  for (const auto &[stop_a_name, map_distances] : distances) {
-    for (const auto &[stop_b_name, dist] : map_distances) {
-      auto a = cat.GetStop(stop_a_name);
-      auto b = cat.GetStop(stop_b_name);
-      auto stops = std::make_pair(a, b);
+static void SerializeContractionHierarchy(
+    const graph::BaseRouter<router::Minutes> &router,
+    transport_catalogue::TransportCatalogue &serial) {
+  const auto hierarchy =
+    dynamic_cast<const graph::ContractionHierarchy<router::Minutes> *>(&router);
 
-      cat.SetDistance(stops, dist);
+  if (hierarchy == nullptr) {
+    return;
+  }
+
+  const auto &data = hierarchy->GetHierarchyData();
+  auto s_hierarchy = serial.mutable_router()->mutable_contraction_hierarchy();
+  const auto shortcut_count = static_cast<int>(data.shortcuts.size());
+
+  s_hierarchy->mutable_rank()->Add(data.ranks.begin(), data.ranks.end());
+  s_hierarchy->mutable_shortcut_from()->Reserve(shortcut_count);
+  s_hierarchy->mutable_shortcut_to()->Reserve(shortcut_count);
+  s_hierarchy->mutable_shortcut_weight()->Reserve(shortcut_count);
+  s_hierarchy->mutable_shortcut_first()->Reserve(shortcut_count);
+  s_hierarchy->mutable_shortcut_second()->Reserve(shortcut_count);
+
+  for (const auto &shortcut : data.shortcuts) {
+    s_hierarchy->add_shortcut_from(shortcut.from);
+    s_hierarchy->add_shortcut_to(shortcut.to);
+    s_hierarchy->add_shortcut_weight(shortcut.weight.count());
+    s_hierarchy->add_shortcut_first(shortcut.first);
+    s_hierarchy->add_shortcut_second(shortcut.second);
+  }
+}
+
+static void SerializeLandmarks(const graph::Landmarks<router::Minutes> *landmarks,
+    transport_catalogue::TransportCatalogue &serial) {
+  if (landmarks == nullptr) {
+    return;
+  }
+
+  const auto &data = landmarks->GetLandmarksData();
+  auto s_landmarks = serial.mutable_router()->mutable_landmarks();
+
+  s_landmarks->mutable_landmark()->Add(data.landmarks.begin(),
+    data.landmarks.end());
+  s_landmarks->mutable_from_landmark()->Reserve(
+    static_cast<int>(data.from_landmarks.size()));
+  for (const auto &distance : data.from_landmarks) {
+    s_landmarks->mutable_from_landmark()->AddAlreadyReserved(distance.count());
+  }
+  s_landmarks->mutable_to_landmark()->Reserve(
+    static_cast<int>(data.to_landmarks.size()));
+  for (const auto &distance : data.to_landmarks) {
+    s_landmarks->mutable_to_landmark()->AddAlreadyReserved(distance.count());
+  }
+}
+
+static void DeserializeStops(TransportCatalogue &cat,
+    const transport_catalogue::TransportCatalogue &serial) {
+  for (const auto &s_stop : serial.stop()) {
+    cat.AddStop(s_stop.name(), {s_stop.latitude(), s_stop.longitude()});
+  }
+
+  for (StopId from = 0; from < cat.GetStops().size(); ++from) {
+    for (const auto &s_dist : serial.stop(static_cast<int>(from))
+      .road_distances()) {
+      cat.SetDistance(from, s_dist.stop_id(),
+        static_cast<int>(s_dist.distance()));
     }
   }
 }
 
 static void DeserializeBuses(TransportCatalogue &cat,
     const transport_catalogue::TransportCatalogue &serial) {
-  for (int i = 0; i < serial.bus_size(); ++i) {
-    Route route;
-    Route final_stops;
+  for (const auto &s_bus : serial.bus()) {
+    const std::vector<StopId> route(s_bus.stop_id().begin(),
+      s_bus.stop_id().end());
 
-    for (int j = 0; j < serial.bus(i).stop_size(); ++j) {
-      route.push_back(cat.GetStop(serial.bus(i).stop(j)));
-    }
+    cat.AddRoute(s_bus.name(), route, s_bus.is_roundtrip());
+  }
+}
 
-    // Определение конечных остановок
-    final_stops.push_back(route.front());
-    if (route.front() != route.back()) {
-      final_stops.push_back(route.back());
-    }
+static NameIndex
+DeserializeNameIndex(const transport_catalogue::NameIndex &s_index) {
+  NameIndex::NameIndexData data;
 
-    // Приведение маршрута вида "stop1 - stop2 - ... stopN" к виду
-    // "stop1 > stop2 > ... > stopN-1 > stopN > stopN-1 > ... > stop2 > stop1"
-    if (!serial.bus(i).is_roundtrip()) {
-      route.insert(route.end(), route.rbegin() + 1, route.rend());
-    }
+  data.seed = s_index.seed();
+  data.name_count = s_index.name_count();
+  data.displacements.assign(s_index.displacement().begin(),
+    s_index.displacement().end());
+  data.ids.assign(s_index.id().begin(), s_index.id().end());
+
+  return NameIndex(std::move(data));
+}
+
+// Индексы имён восстанавливаются до добавления остановок и автобусов, поэтому
+// ассоциативные массивы имён при загрузке не заполняются
+static void DeserializeNameIndexes(TransportCatalogue &cat,
+    const transport_catalogue::TransportCatalogue &serial) {
+  cat.SetNameIndexes(DeserializeNameIndex(serial.stop_name_index()),
+    DeserializeNameIndex(serial.bus_name_index()));
+}
 
-    cat.AddRoute({serial.bus(i).name(), route, final_stops});
+// Порядок подсказок берётся из базы, приведённые названия вычисляются по
+// названиям остановок
+static void DeserializeStopSearch(TransportCatalogue &cat,
+    const transport_catalogue::TransportCatalogue &serial) {
+  const auto &s_stop_search = serial.stop_search();
+  StopSearch::StopSearchData data;
+
+  data.stops.assign(s_stop_search.stop().begin(), s_stop_search.stop().end());
+  data.words.reserve(s_stop_search.word_stop_size());
+  for (int i = 0; i < s_stop_search.word_stop_size(); ++i) {
+    data.words.push_back({s_stop_search.word_stop(i),
+      s_stop_search.word_offset(i)});
+  }
+
+  std::vector<std::string_view> names;
+  names.reserve(cat.GetStops().size());
+  for (const auto &stop : cat.GetStops()) {
+    names.push_back(stop.name);
   }
+
+  cat.SetStopSearch(StopSearch(names, std::move(data)));
+}
+
+static void DeserializeSpatialIndex(TransportCatalogue &cat,
+    const transport_catalogue::TransportCatalogue &serial) {
+  const auto &s_spatial_index = serial.spatial_index();
+  SpatialIndex::SpatialIndexData data;
+
+  data.stops.assign(s_spatial_index.stop().begin(),
+    s_spatial_index.stop().end());
+  data.axes.reserve(s_spatial_index.axis_size());
+  for (const uint32_t axis : s_spatial_index.axis()) {
+    data.axes.push_back(static_cast<uint8_t>(axis));
+  }
+
+  std::vector<geo::Coordinates> coordinates;
+  coordinates.reserve(cat.GetStops().size());
+  for (const auto &stop : cat.GetStops()) {
+    coordinates.push_back(cat.GetCoordinates(stop.id));
+  }
+
+  cat.SetSpatialIndex(SpatialIndex(coordinates, std::move(data)));
 }
 
 static void DeserializeRenderSettings(renderer::RenderSettings &rs,
@@ -314,45 +505,70 @@ static void DeserializeRoutingSettings(router::RoutingSettings &ros,
   std::chrono::minutes m{serial.router().routing_settings().bus_wait_time()};
   ros.bus_wait_time = m;
   ros.bus_velocity = serial.router().routing_settings().bus_velocity();
+  ros.router_type = static_cast<router::RouterType>(
+    serial.router().routing_settings().router_type());
+  ros.thread_count = serial.router().routing_settings().thread_count();
+  ros.landmark_count = serial.router().routing_settings().landmark_count();
+  ros.route_cache_capacity =
+    serial.router().routing_settings().route_cache_capacity();
+  ros.vertex_order = static_cast<router::VertexOrder>(
+    serial.router().routing_settings().vertex_order());
+  ros.hub_labels = serial.router().routing_settings().hub_labels();
+  ros.memory_budget = serial.router().routing_settings().memory_budget();
 }
 
 static void
 DeserializeGraph(graph::DirectedWeightedGraph<router::Minutes> &graph,
     const transport_catalogue::TransportCatalogue &serial) {
-  auto s_graph = serial.router().graph();
-  auto &edges = graph.GetEdges();
-  auto &incidence_lists = graph.GetIncidenceList();
-
-  edges.clear();
-  for (int i = 0; i < s_graph.edge_size(); ++i) {
-    graph::Edge<router::Minutes> edge = {
-      s_graph.edge(i).from(),
-      s_graph.edge(i).to(),
-      static_cast<router::Minutes>(s_graph.edge(i).weight())};
-    edges.push_back(edge);
-  }
-
-  incidence_lists.resize(s_graph.incidence_list_size());
-  for (int i = 0; i < s_graph.incidence_list_size(); ++i) {
-    for (int j = 0; j < s_graph.incidence_list(i).edge_id_size(); ++j) {
-      incidence_lists[i].push_back(s_graph.incidence_list(i).edge_id(j));
+  const auto &s_graph = serial.router().graph();
+  const auto &s_offsets = s_graph.edge_offset();
+  const int edge_count = s_graph.edge_target_size();
+  if (s_offsets.empty()
+    || s_offsets.Get(s_offsets.size() - 1) != static_cast<uint32_t>(edge_count)
+    || s_graph.edge_weight_size() != edge_count) {
+    throw std::invalid_argument("Graph edges don't match their offsets");
+  }
+
+  // Рёбра добавляются в порядке CSR, поэтому сохраняют свои номера
+  graph = graph::DirectedWeightedGraph<router::Minutes>(s_offsets.size() - 1);
+  for (int vertex = 0; vertex + 1 < s_offsets.size(); ++vertex) {
+    for (uint32_t edge_id = s_offsets.Get(vertex);
+      edge_id < s_offsets.Get(vertex + 1); ++edge_id) {
+      graph.AddEdge({
+        static_cast<graph::VertexId>(vertex),
+        s_graph.edge_target(static_cast<int>(edge_id)),
+        router::Minutes(s_graph.edge_weight(static_cast<int>(edge_id)))
+      });
     }
   }
+
+  graph::WeightParameters weight_parameters;
+  weight_parameters.line_speed = s_graph.line_speed();
+  weight_parameters.explicit_weight_scale = s_graph.explicit_weight_scale();
+  graph.SetWeightParameters(weight_parameters);
+  for (const auto &s_line : s_graph.line()) {
+    graph::EdgeLine line;
+    line.from.assign(s_line.from().begin(), s_line.from().end());
+    line.to.assign(s_line.to().begin(), s_line.to().end());
+    line.lengths.assign(s_line.length().begin(), s_line.length().end());
+    graph.AddLine(std::move(line));
+  }
+  graph.Freeze();
 }
 
 static void
 DeserializeStopVertexIds(const TransportCatalogue &cat,
-  std::unordered_map<const Stop *, router::TransportRouter::StopVertexIds,
-    Hasher> &stops_vertex_ids,
+  std::vector<router::TransportRouter::StopVertexIds> &stops_vertex_ids,
     const transport_catalogue::TransportCatalogue &serial) {
+  stops_vertex_ids.resize(cat.GetStops().size());
   for (int i = 0; i < serial.router().stops_vertex_id_size(); ++i) {
-    auto s_svid = serial.router().stops_vertex_id(i);
+    const auto &s_svid = serial.router().stops_vertex_id(i);
 
     router::TransportRouter::StopVertexIds svid = {
       s_svid.id().in(),
       s_svid.id().out()
     };
-    stops_vertex_ids[cat.GetStop(s_svid.stop_name())] = svid;
+    stops_vertex_ids.at(s_svid.stop_id()) = svid;
   }
 }
 
@@ -361,7 +577,7 @@ DeserializeVertexes(const TransportCatalogue &cat,
     std::vector<const Stop *> &vertexes,
     const transport_catalogue::TransportCatalogue &serial) {
   for (int i = 0; i < serial.router().vertex_size(); ++i) {
-    vertexes.push_back(cat.GetStop(serial.router().vertex(i).stop_name()));
+    vertexes.push_back(&cat.GetStop(serial.router().vertex(i).stop_id()));
   }
 }
 
@@ -370,11 +586,11 @@ DeserializeEdges(const TransportCatalogue &cat,
     std::vector<router::TransportRouter::EdgeInfo> &edges,
     const transport_catalogue::TransportCatalogue &serial) {
   for (int i = 0; i < serial.router().edge_size(); ++i) {
-    auto s_edge = serial.router().edge(i);
+    const auto &s_edge = serial.router().edge(i);
 
     if (s_edge.has_bus_edge()) {
       router::TransportRouter::BusEdge bus_edge = {
-        cat.GetBus(s_edge.bus_edge().bus_name()),
+        &cat.GetBus(s_edge.bus_edge().bus_id()),
         s_edge.bus_edge().span_count()
       };
 
@@ -385,6 +601,207 @@ DeserializeEdges(const TransportCatalogue &cat,
   }
 }
 
+static void DeserializeLineBuses(const TransportCatalogue &cat,
+    std::vector<const Bus *> &line_buses,
+    const transport_catalogue::TransportCatalogue &serial) {
+  for (const auto bus_id : serial.router().line_bus_id()) {
+    line_buses.push_back(&cat.GetBus(bus_id));
+  }
+}
+
+static void DeserializeCoveredLines(const TransportCatalogue &cat,
+    std::vector<router::TransportRouter::CoveredLine> &covered_lines,
+    const transport_catalogue::TransportCatalogue &serial) {
+  for (const auto &s_covered_line : serial.router().covered_line()) {
+    covered_lines.push_back({
+      &cat.GetBus(s_covered_line.bus_id()),
+      s_covered_line.line(),
+      s_covered_line.begin(),
+      s_covered_line.end()
+    });
+  }
+}
+
+// Восстанавливает маршрутизатор по сохранённой таблице кратчайших путей.
+// Возвращает false, если таблицы в базе нет или она не соответствует графу
+static bool DeserializeRoutesInternalData(router::TransportRouter &router,
+    const transport_catalogue::TransportCatalogue &serial) {
+  using RoutesInternalData =
+    graph::Router<router::Minutes>::RoutesInternalData;
+
+  if (!serial.router().has_routes_internal_data()) {
+    return false;
+  }
+
+  const auto &s_routes = serial.router().routes_internal_data();
+  const size_t vertex_count = router.GetGraph().GetVertexCount();
+  const size_t cell_count = vertex_count * vertex_count;
+
+  if (static_cast<size_t>(s_routes.weight_size()) != cell_count
+    || static_cast<size_t>(s_routes.prev_edge_size()) != cell_count) {
+    return false;
+  }
+
+  RoutesInternalData routes;
+  routes.vertex_count = vertex_count;
+  routes.weights.reserve(cell_count);
+  for (const double weight : s_routes.weight()) {
+    routes.weights.emplace_back(weight);
+  }
+  routes.prev_edges.assign(s_routes.prev_edge().begin(),
+    s_routes.prev_edge().end());
+
+  router.SetRouter(std::make_unique<graph::Router<router::Minutes>>(
+    router.GetGraph(), std::move(routes)));
+  return true;
+}
+
+// Восстанавливает иерархию сжатия графа. Возвращает false, если иерархии в
+// базе нет
+static bool DeserializeContractionHierarchy(router::TransportRouter &router,
+    const transport_catalogue::TransportCatalogue &serial) {
+  using Hierarchy = graph::ContractionHierarchy<router::Minutes>;
+
+  if (!serial.router().has_contraction_hierarchy()) {
+    return false;
+  }
+
+  const auto &s_hierarchy = serial.router().contraction_hierarchy();
+  const int shortcut_count = s_hierarchy.shortcut_from_size();
+
+  if (s_hierarchy.shortcut_to_size() != shortcut_count
+    || s_hierarchy.shortcut_weight_size() != shortcut_count
+    || s_hierarchy.shortcut_first_size() != shortcut_count
+    || s_hierarchy.shortcut_second_size() != shortcut_count) {
+    return false;
+  }
+
+  Hierarchy::HierarchyData data;
+  data.ranks.assign(s_hierarchy.rank().begin(), s_hierarchy.rank().end());
+  data.shortcuts.reserve(shortcut_count);
+  for (int i = 0; i < shortcut_count; ++i) {
+    data.shortcuts.push_back({
+      s_hierarchy.shortcut_from(i),
+      s_hierarchy.shortcut_to(i),
+      router::Minutes(s_hierarchy.shortcut_weight(i)),
+      s_hierarchy.shortcut_first(i),
+      s_hierarchy.shortcut_second(i)});
+  }
+
+  router.SetRouter(std::make_unique<Hierarchy>(router.GetGraph(),
+    std::move(data)));
+  return true;
+}
+
+// Восстанавливает ориентиры, если они сохранены в базе
+static void DeserializeLandmarks(router::TransportRouter &router,
+    const transport_catalogue::TransportCatalogue &serial) {
+  using Landmarks = graph::Landmarks<router::Minutes>;
+
+  if (!serial.router().has_landmarks()) {
+    return;
+  }
+
+  const auto &s_landmarks = serial.router().landmarks();
+  Landmarks::LandmarksData data;
+  data.landmarks.assign(s_landmarks.landmark().begin(),
+    s_landmarks.landmark().end());
+  data.from_landmarks.reserve(s_landmarks.from_landmark_size());
+  for (const double distance : s_landmarks.from_landmark()) {
+    data.from_landmarks.emplace_back(distance);
+  }
+  data.to_landmarks.reserve(s_landmarks.to_landmark_size());
+  for (const double distance : s_landmarks.to_landmark()) {
+    data.to_landmarks.emplace_back(distance);
+  }
+
+  router.SetLandmarks(std::make_shared<Landmarks>(router.GetGraph(),
+    std::move(data)));
+}
+
+static void SerializeHubLabels(
+    const graph::HubLabels<router::Minutes> *hub_labels,
+    transport_catalogue::TransportCatalogue &serial) {
+  if (hub_labels == nullptr) {
+    return;
+  }
+
+  const auto &data = hub_labels->GetHubLabelsData();
+  auto s_hub_labels = serial.mutable_router()->mutable_hub_labels();
+
+  s_hub_labels->mutable_out_offset()->Add(data.out_offsets.begin(),
+    data.out_offsets.end());
+  s_hub_labels->mutable_out_hub()->Add(data.out_hubs.begin(),
+    data.out_hubs.end());
+  s_hub_labels->mutable_out_weight()->Reserve(
+    static_cast<int>(data.out_weights.size()));
+  for (const auto &weight : data.out_weights) {
+    s_hub_labels->mutable_out_weight()->AddAlreadyReserved(weight.count());
+  }
+  s_hub_labels->mutable_in_offset()->Add(data.in_offsets.begin(),
+    data.in_offsets.end());
+  s_hub_labels->mutable_in_hub()->Add(data.in_hubs.begin(),
+    data.in_hubs.end());
+  s_hub_labels->mutable_in_weight()->Reserve(
+    static_cast<int>(data.in_weights.size()));
+  for (const auto &weight : data.in_weights) {
+    s_hub_labels->mutable_in_weight()->AddAlreadyReserved(weight.count());
+  }
+}
+
+// Восстанавливает метки хабов, если они сохранены в базе
+static void DeserializeHubLabels(router::TransportRouter &router,
+    const transport_catalogue::TransportCatalogue &serial) {
+  using HubLabels = graph::HubLabels<router::Minutes>;
+
+  if (!serial.router().has_hub_labels()) {
+    return;
+  }
+
+  const auto &s_hub_labels = serial.router().hub_labels();
+  HubLabels::HubLabelsData data;
+  data.out_offsets.assign(s_hub_labels.out_offset().begin(),
+    s_hub_labels.out_offset().end());
+  data.out_hubs.assign(s_hub_labels.out_hub().begin(),
+    s_hub_labels.out_hub().end());
+  data.out_weights.reserve(s_hub_labels.out_weight_size());
+  for (const double weight : s_hub_labels.out_weight()) {
+    data.out_weights.emplace_back(weight);
+  }
+  data.in_offsets.assign(s_hub_labels.in_offset().begin(),
+    s_hub_labels.in_offset().end());
+  data.in_hubs.assign(s_hub_labels.in_hub().begin(),
+    s_hub_labels.in_hub().end());
+  data.in_weights.reserve(s_hub_labels.in_weight_size());
+  for (const double weight : s_hub_labels.in_weight()) {
+    data.in_weights.emplace_back(weight);
+  }
+
+  router.SetHubLabels(std::make_shared<HubLabels>(router.GetGraph(),
+    std::move(data)));
+}
+
+static void SerializeComponents(const graph::ConnectedComponents &components,
+    transport_catalogue::TransportCatalogue &serial) {
+  const auto &labels = components.GetLabels();
+  serial.mutable_router()->mutable_component_label()->Add(labels.begin(),
+    labels.end());
+}
+
+// Метки компонент рассчитываются заново, если в базе их нет
+static void DeserializeComponents(router::TransportRouter &router,
+    const transport_catalogue::TransportCatalogue &serial) {
+  const auto &s_labels = serial.router().component_label();
+  if (s_labels.empty()) {
+    router.SetComponents(graph::ConnectedComponents(router.GetGraph()));
+    return;
+  }
+
+  router.SetComponents(graph::ConnectedComponents(router.GetGraph(),
+    std::vector<graph::ConnectedComponents::Label>(s_labels.begin(),
+      s_labels.end())));
+}
+
 static void SerializeRoute(const router::TransportRouter &router,
     transport_catalogue::TransportCatalogue &serial) {
   SerializeRoutingSettings(router.GetRoutingSettings(), serial);
@@ -392,6 +809,13 @@ static void SerializeRoute(const router::TransportRouter &router,
   SerializeStopVertexIds(router.GetStopsVertexIds(), serial);
   SerializeVertexes(router.GetVertexes(), serial);
   SerializeEdges(router.GetEdges(), serial);
+  SerializeLineBuses(router.GetLineBuses(), serial);
+  SerializeCoveredLines(router.GetCoveredLines(), serial);
+  SerializeRoutesInternalData(router.GetRouter(), serial);
+  SerializeContractionHierarchy(router.GetRouter(), serial);
+  SerializeLandmarks(router.GetLandmarks(), serial);
+  SerializeHubLabels(router.GetHubLabels(), serial);
+  SerializeComponents(router.GetComponents(), serial);
 }
 
 static void DeserializeRoute(const TransportCatalogue &cat,
@@ -402,40 +826,83 @@ static void DeserializeRoute(const TransportCatalogue &cat,
   DeserializeStopVertexIds(cat, router.GetStopsVertexIds(), serial);
   DeserializeVertexes(cat, router.GetVertexes(), serial);
   DeserializeEdges(cat, router.GetEdges(), serial);
+  DeserializeLineBuses(cat, router.GetLineBuses(), serial);
+  DeserializeCoveredLines(cat, router.GetCoveredLines(), serial);
+  DeserializeLandmarks(router, serial);
+  DeserializeHubLabels(router, serial);
+  DeserializeComponents(router, serial);
 
   // При создании пустого объекта TransportRouter для последующей десереализации
-  // его полей, указатель на Router, по умолчанию, равен nullptr. Необходимо
-  // обновить указатель на объект класса Router, конструктор которого принимает
-  // граф. Граф десереализуется после того, как пустой объект TransportRouter
-  // сконструирован, поэтому и необходимо обновить указатель.
-  router.UpdateRouterPtr();
+  // его полей, указатель на Router, по умолчанию, равен nullptr. Если в базе
+  // сохранены таблица кратчайших путей или иерархия сжатия графа, маршрутизатор
+  // восстанавливается по ним. Сохранённые ориентиры используются при создании
+  // маршрутизатора вместо повторного расчёта.
+  // Иначе необходимо обновить указатель на объект класса Router, конструктор
+  // которого принимает граф. Граф десереализуется после того, как пустой объект
+  // TransportRouter сконструирован, поэтому и необходимо обновить указатель.
+  if (!DeserializeRoutesInternalData(router, serial)
+    && !DeserializeContractionHierarchy(router, serial)) {
+    router.UpdateRouterPtr(cat);
+  }
+  router.ResetRouteCache();
 }
 
-void SerializeDB(const TransportCatalogue &cat,
+bool SerializeDB(const TransportCatalogue &cat,
     const renderer::RenderSettings &rs,
     const router::TransportRouter &router,
-    const std::filesystem::path &path) {
-  std::ofstream ofile(path, std::ios::binary);
+    const std::filesystem::path &path, std::ostream &log) {
+  using namespace std::string_view_literals;
+
   transport_catalogue::TransportCatalogue s_tc;
 
   SerializeStops(cat, s_tc);
   SerializeBuses(cat, s_tc);
+  SerializeNameIndexes(cat, s_tc);
+  SerializeStopSearch(cat, s_tc);
+  SerializeSpatialIndex(cat, s_tc);
   SerializeRenderSettings(rs, s_tc);
   SerializeRoute(router, s_tc);
 
-  s_tc.SerializeToOstream(&ofile);
+  // Таблица кратчайших путей восстанавливается пересчётом, поэтому без неё
+  // обходятся, если вместе с остальными разделами база слишком велика
+  if (s_tc.ByteSizeLong() > MAX_MESSAGE_SIZE
+    && s_tc.router().has_routes_internal_data()) {
+    s_tc.mutable_router()->clear_routes_internal_data();
+  }
+  if (s_tc.ByteSizeLong() > MAX_MESSAGE_SIZE) {
+    return false;
+  }
+
+  const bool has_routes_internal_data = dynamic_cast<
+    const graph::Router<router::Minutes> *>(&router.GetRouter()) != nullptr;
+  if (has_routes_internal_data && !s_tc.router().has_routes_internal_data()) {
+    log << "Routes table is too large for the base, "sv
+      << "it will be rebuilt on load\n"sv;
+  }
+
+  // Файл открывается только для готовой базы, чтобы неудача не затёрла
+  // прежнюю
+  std::ofstream ofile(path, std::ios::binary);
+  return s_tc.SerializeToOstream(&ofile);
 }
 
-void DeserializeDB(TransportCatalogue &cat, renderer::RenderSettings &rs,
+bool DeserializeDB(TransportCatalogue &cat, renderer::RenderSettings &rs,
     router::TransportRouter &router, const std::filesystem::path &path) {
   std::ifstream ifile(path, std::ios::binary);
   transport_catalogue::TransportCatalogue s_tc;
-  s_tc.ParseFromIstream(&ifile);
+  if (!s_tc.ParseFromIstream(&ifile)) {
+    return false;
+  }
 
+  DeserializeNameIndexes(cat, s_tc);
   DeserializeStops(cat, s_tc);
   DeserializeBuses(cat, s_tc);
+  DeserializeStopSearch(cat, s_tc);
+  DeserializeSpatialIndex(cat, s_tc);
   DeserializeRenderSettings(rs, s_tc);
   DeserializeRoute(cat, router, s_tc);
+
+  return true;
 }
 
 } // namespace tc::serial
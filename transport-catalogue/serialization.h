@@ -5,15 +5,19 @@
 #include "transport_router.h"
 
 #include <filesystem>
+#include <ostream>
 
 namespace tc::serial {
 
-void SerializeDB(const TransportCatalogue &cat,
+// Возвращает false, если базу не удалось записать. О разделах, не вошедших
+// в базу из-за её размера, сообщает в log
+bool SerializeDB(const TransportCatalogue &cat,
   const renderer::RenderSettings &rs,
   const router::TransportRouter &router,
-  const std::filesystem::path &path);
+  const std::filesystem::path &path, std::ostream &log);
 
-void DeserializeDB(TransportCatalogue &cat, renderer::RenderSettings &rs,
+// Возвращает false, если базу не удалось прочитать
+bool DeserializeDB(TransportCatalogue &cat, renderer::RenderSettings &rs,
   router::TransportRouter &router, const std::filesystem::path &path);
 
 } // namespace tc::serial
@@ -0,0 +1,185 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace tc {
+
+namespace {
+
+// Запас для оценки расстояния до секущей плоскости на погрешность округления
+// при вычислении хорды
+const double DISTANCE_TOLERANCE = 1e-3;
+
+bool IsCloser(const NearestStop &lhs, const NearestStop &rhs) {
+  return std::pair(lhs.distance, lhs.stop) < std::pair(rhs.distance, rhs.stop);
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(const std::vector<geo::Coordinates> &coordinates) {
+  std::vector<Point> points;
+  points.reserve(coordinates.size());
+  for (const auto &stop_coordinates : coordinates) {
+    points.push_back(ToPoint(stop_coordinates));
+  }
+
+  data_.stops.resize(coordinates.size());
+  for (StopId stop = 0; stop < coordinates.size(); ++stop) {
+    data_.stops[stop] = stop;
+  }
+  data_.axes.assign(coordinates.size(), 0);
+  Build(0, data_.stops.size(), points);
+
+  points_.reserve(coordinates.size());
+  for (const StopId stop : data_.stops) {
+    points_.push_back(points[stop]);
+  }
+}
+
+SpatialIndex::SpatialIndex(const std::vector<geo::Coordinates> &coordinates,
+  SpatialIndexData data) : data_(std::move(data)) {
+  const bool is_valid = data_.stops.size() == coordinates.size()
+    && data_.axes.size() == coordinates.size()
+    && std::all_of(data_.stops.begin(), data_.stops.end(),
+      [&coordinates](StopId stop) {
+        return stop < coordinates.size();
+      })
+    && std::all_of(data_.axes.begin(), data_.axes.end(),
+      [](uint8_t axis) {
+        return axis < 3;
+      });
+  if (!is_valid) {
+    throw std::invalid_argument("Spatial index data doesn't match the stops");
+  }
+
+  points_.reserve(coordinates.size());
+  for (const StopId stop : data_.stops) {
+    points_.push_back(ToPoint(coordinates[stop]));
+  }
+}
+
+std::vector<NearestStop> SpatialIndex::FindNearest(
+  geo::Coordinates coordinates, double radius, size_t count) const {
+  std::vector<NearestStop> nearest;
+  if (count == 0) {
+    return nearest;
+  }
+
+  nearest.reserve(std::min(count, data_.stops.size()) + 1);
+  Search(0, data_.stops.size(),
+    {ToPoint(coordinates), radius, count}, nearest);
+  std::sort_heap(nearest.begin(), nearest.end(), IsCloser);
+
+  return nearest;
+}
+
+const SpatialIndex::SpatialIndexData &
+SpatialIndex::GetSpatialIndexData() const {
+  return data_;
+}
+
+SpatialIndex::Point SpatialIndex::ToPoint(geo::Coordinates coordinates) {
+  static const double dr = 3.1415926535 / 180.;
+
+  const double lat = coordinates.lat * dr;
+  const double lng = coordinates.lng * dr;
+  return {
+    std::cos(lat) * std::cos(lng),
+    std::cos(lat) * std::sin(lng),
+    std::sin(lat)
+  };
+}
+
+// Расстояние по поверхности через длину хорды: в отличие от арккосинуса
+// скалярного произведения не теряет точность на близких точках
+double SpatialIndex::ComputeDistance(const Point &from, const Point &to) {
+  double chord = 0;
+  for (size_t axis = 0; axis < from.size(); ++axis) {
+    chord += (from[axis] - to[axis]) * (from[axis] - to[axis]);
+  }
+  chord = std::sqrt(chord);
+  return 2 * geo::r_Earth * std::asin(std::min(chord / 2, 1.0));
+}
+
+// Узел делит диапазон по оси наибольшего разброса точек: остановки города
+// лежат почти в одной плоскости, и чередование осей делило бы часть уровней
+// по оси с ничтожным разбросом
+void SpatialIndex::Build(size_t begin, size_t end,
+  const std::vector<Point> &points) {
+  if (end - begin <= 1) {
+    return;
+  }
+
+  uint8_t axis = 0;
+  double max_spread = -1;
+  for (uint8_t candidate = 0; candidate < 3; ++candidate) {
+    const auto [min_it, max_it] = std::minmax_element(
+      data_.stops.begin() + begin, data_.stops.begin() + end,
+      [&points, candidate](StopId lhs, StopId rhs) {
+        return points[lhs][candidate] < points[rhs][candidate];
+      });
+    const double spread = points[*max_it][candidate]
+      - points[*min_it][candidate];
+    if (spread > max_spread) {
+      max_spread = spread;
+      axis = candidate;
+    }
+  }
+
+  const size_t middle = begin + (end - begin) / 2;
+  std::nth_element(data_.stops.begin() + begin, data_.stops.begin() + middle,
+    data_.stops.begin() + end,
+    [&points, axis](StopId lhs, StopId rhs) {
+      return points[lhs][axis] < points[rhs][axis];
+    });
+  data_.axes[middle] = axis;
+
+  Build(begin, middle, points);
+  Build(middle + 1, end, points);
+}
+
+// nearest - куча с самой дальней из найденных остановок в вершине
+void SpatialIndex::Search(size_t begin, size_t end, const Query &query,
+  std::vector<NearestStop> &nearest) const {
+  if (begin >= end) {
+    return;
+  }
+
+  const size_t middle = begin + (end - begin) / 2;
+  const double distance = ComputeDistance(query.point, points_[middle]);
+  if (distance <= query.radius) {
+    nearest.push_back({data_.stops[middle], distance});
+    std::push_heap(nearest.begin(), nearest.end(), IsCloser);
+    if (nearest.size() > query.count) {
+      std::pop_heap(nearest.begin(), nearest.end(), IsCloser);
+      nearest.pop_back();
+    }
+  }
+
+  const uint8_t axis = data_.axes[middle];
+  const double offset = query.point[axis] - points_[middle][axis];
+  const bool is_left_near = offset < 0;
+  if (is_left_near) {
+    Search(begin, middle, query, nearest);
+  } else {
+    Search(middle + 1, end, query, nearest);
+  }
+
+  // Хорда до любой точки за плоскостью не короче расстояния до плоскости
+  const double min_distance = 2 * geo::r_Earth
+    * std::asin(std::min(std::abs(offset) / 2, 1.0)) - DISTANCE_TOLERANCE;
+  const double max_distance = nearest.size() == query.count
+    ? nearest.front().distance : query.radius;
+  if (min_distance <= max_distance) {
+    if (is_left_near) {
+      Search(middle + 1, end, query, nearest);
+    } else {
+      Search(begin, middle, query, nearest);
+    }
+  }
+}
+
+} // namespace tc
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tc {
+
+struct NearestStop {
+  StopId stop{};
+  double distance{};  // Метры
+};
+
+// Статическое k-d дерево над остановками. Координаты переводятся в точки
+// единичной сферы: длина хорды монотонна по расстоянию по поверхности, поэтому
+// расстояние до секущей плоскости узла даёт нижнюю оценку расстояния до всех
+// остановок по другую её сторону. Дерево хранится неявно: узел диапазона
+// [begin, end) лежит в его середине, поддеревья - слева и справа от неё
+class SpatialIndex {
+public:
+  struct SpatialIndexData {
+    std::vector<StopId> stops;  // По узлам
+    std::vector<uint8_t> axes;  // Ось секущей плоскости по узлам
+  };
+
+  SpatialIndex() = default;
+
+  // coordinates - координаты остановок по номерам
+  explicit SpatialIndex(const std::vector<geo::Coordinates> &coordinates);
+
+  // Восстанавливает дерево по сохранённому порядку узлов
+  SpatialIndex(const std::vector<geo::Coordinates> &coordinates,
+    SpatialIndexData data);
+
+  // Не более count ближайших к точке остановок не дальше radius метров в
+  // порядке возрастания расстояния
+  std::vector<NearestStop> FindNearest(geo::Coordinates coordinates,
+    double radius, size_t count) const;
+
+  const SpatialIndexData &GetSpatialIndexData() const;
+
+private:
+  using Point = std::array<double, 3>;
+
+  struct Query {
+    Point point;
+    double radius;
+    size_t count;
+  };
+
+  static Point ToPoint(geo::Coordinates coordinates);
+  static double ComputeDistance(const Point &from, const Point &to);
+
+  void Build(size_t begin, size_t end, const std::vector<Point> &points);
+  void Search(size_t begin, size_t end, const Query &query,
+    std::vector<NearestStop> &nearest) const;
+
+  std::vector<Point> points_;  // По узлам
+  SpatialIndexData data_;
+};
+
+} // namespace tc
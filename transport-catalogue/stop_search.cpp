@@ -0,0 +1,326 @@
+#include "stop_search.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace tc {
+
+namespace {
+
+// Опечатки допускаются в запросах не короче трёх символов, а две опечатки -
+// в запросах не короче шести
+const size_t MIN_FUZZY_QUERY_LENGTH = 3;
+const size_t MIN_TWO_ERRORS_QUERY_LENGTH = 6;
+
+char32_t ToLower(char32_t c) {
+  if (c >= U'A' && c <= U'Z') {
+    return c + (U'a' - U'A');
+  }
+  if (c >= U'А' && c <= U'Я') {
+    return c + (U'а' - U'А');
+  }
+  if (c >= U'Ѐ' && c <= U'Џ') {
+    c += U'ѐ' - U'Ѐ';
+  }
+  return c == U'ё' ? U'е' : c;
+}
+
+// Отметки выданных остановок. Отметка действительна, если совпадает с
+// поколением текущего запроса, поэтому сброс между запросами не требует
+// прохода по всем остановкам
+struct SeenStops {
+  std::vector<uint32_t> marks;
+  uint32_t generation = 0;
+
+  void Reset(size_t stop_count) {
+    if (marks.size() < stop_count) {
+      marks.resize(stop_count, 0);
+    }
+
+    // При переполнении счётчика поколений метки сбрасываются явно
+    if (++generation == 0) {
+      std::fill(marks.begin(), marks.end(), 0);
+      generation = 1;
+    }
+  }
+
+  // Возвращает false, если остановка уже отмечена в этом запросе
+  bool Mark(StopId stop) {
+    if (marks[stop] == generation) {
+      return false;
+    }
+    marks[stop] = generation;
+    return true;
+  }
+};
+
+SeenStops &GetSeenStops() {
+  static thread_local SeenStops seen_stops;
+  return seen_stops;
+}
+
+bool StartsWith(std::u32string_view text, std::u32string_view prefix) {
+  return text.substr(0, prefix.size()) == prefix;
+}
+
+// Поиск строк, начало которых отличается от запроса не более чем на
+// max_errors правок, в упорядоченном массиве. Столбец depth таблицы
+// расстояний редактирования зависит только от первых depth символов строки,
+// поэтому столбцы общего начала соседних строк переиспользуются. Минимум
+// столбца не убывает с глубиной: если он превысил max_errors, продолжения
+// этого начала не ближе к запросу, чем уже найденное расстояние
+class FuzzyMatcher {
+public:
+  FuzzyMatcher(std::u32string_view query, size_t max_errors)
+    : query_(query), max_errors_(max_errors),
+    max_depth_(query.size() + max_errors) {
+    columns_.resize(max_depth_ + 1, std::vector<size_t>(query_.size() + 1));
+    distances_.resize(max_depth_ + 1);
+    for (size_t i = 0; i <= query_.size(); ++i) {
+      columns_[0][i] = i;
+    }
+    distances_[0] = query_.size();
+  }
+
+  template <typename Entry, typename GetText, typename GetStop>
+  void AddCandidates(const std::vector<Entry> &entries, GetText get_text,
+    GetStop get_stop,
+    std::vector<std::pair<size_t, StopId>> &candidates) {
+    std::u32string_view previous;
+    size_t computed_depth = 0;
+
+    for (size_t i = 0; i < entries.size();) {
+      const std::u32string_view text = get_text(entries[i]).substr(0,
+        max_depth_);
+
+      size_t depth = 0;
+      while (depth < computed_depth && depth < text.size()
+        && previous[depth] == text[depth]) {
+        ++depth;
+      }
+      bool is_pruned = depth > 0 && GetColumnMin(depth) > max_errors_;
+      for (; depth < text.size() && !is_pruned; ++depth) {
+        ComputeColumn(depth + 1, text[depth]);
+        is_pruned = GetColumnMin(depth + 1) > max_errors_;
+      }
+      previous = text;
+      computed_depth = depth;
+
+      // Строки с тем же началом до отсечения находятся на том же расстоянии
+      const size_t distance = distances_[depth];
+      const std::u32string_view prefix = text.substr(0, depth);
+      do {
+        if (distance <= max_errors_) {
+          candidates.emplace_back(distance, get_stop(entries[i]));
+        }
+        ++i;
+      } while (is_pruned && i < entries.size()
+        && StartsWith(get_text(entries[i]), prefix));
+    }
+  }
+
+private:
+  void ComputeColumn(size_t depth, char32_t c) {
+    const auto &previous = columns_[depth - 1];
+    auto &column = columns_[depth];
+
+    column[0] = depth;
+    for (size_t i = 1; i <= query_.size(); ++i) {
+      column[i] = std::min({previous[i] + 1, column[i - 1] + 1,
+        previous[i - 1] + (query_[i - 1] != c ? 1 : 0)});
+    }
+    distances_[depth] = std::min(distances_[depth - 1], column.back());
+  }
+
+  size_t GetColumnMin(size_t depth) const {
+    return *std::min_element(columns_[depth].begin(), columns_[depth].end());
+  }
+
+  std::u32string_view query_;
+  size_t max_errors_;
+  size_t max_depth_;
+  // Столбцы таблицы по длине начала строки и наименьшие расстояния от
+  // запроса до начал не длиннее этой длины
+  std::vector<std::vector<size_t>> columns_;
+  std::vector<size_t> distances_;
+};
+
+} // namespace
+
+StopSearch::StopSearch(const std::vector<std::string_view> &names) {
+  keys_.reserve(names.size());
+  for (const auto name : names) {
+    keys_.push_back(Normalize(name));
+  }
+
+  data_.stops.resize(names.size());
+  for (StopId stop = 0; stop < names.size(); ++stop) {
+    data_.stops[stop] = stop;
+  }
+  std::stable_sort(data_.stops.begin(), data_.stops.end(),
+    [this](StopId lhs, StopId rhs) {
+      return keys_[lhs] < keys_[rhs];
+    });
+
+  for (StopId stop = 0; stop < keys_.size(); ++stop) {
+    const Key &key = keys_[stop];
+    for (uint32_t offset = 1; offset < key.size(); ++offset) {
+      if (IsSeparator(key[offset - 1]) && !IsSeparator(key[offset])) {
+        data_.words.push_back({stop, offset});
+      }
+    }
+  }
+  std::stable_sort(data_.words.begin(), data_.words.end(),
+    [this](const WordEntry &lhs, const WordEntry &rhs) {
+      return GetSuffix(lhs) < GetSuffix(rhs);
+    });
+}
+
+StopSearch::StopSearch(const std::vector<std::string_view> &names,
+  StopSearchData data) : data_(std::move(data)) {
+  keys_.reserve(names.size());
+  for (const auto name : names) {
+    keys_.push_back(Normalize(name));
+  }
+
+  const bool is_valid = data_.stops.size() == keys_.size()
+    && std::all_of(data_.stops.begin(), data_.stops.end(),
+      [this](StopId stop) {
+        return stop < keys_.size();
+      })
+    && std::all_of(data_.words.begin(), data_.words.end(),
+      [this](const WordEntry &word) {
+        return word.stop < keys_.size()
+          && word.offset < keys_[word.stop].size();
+      });
+  if (!is_valid) {
+    throw std::invalid_argument("Stop search data doesn't match the stops");
+  }
+}
+
+std::vector<StopId> StopSearch::Find(std::string_view query,
+  size_t limit) const {
+  const Key key = Normalize(query);
+  std::vector<StopId> stops;
+  if (key.empty() || limit == 0) {
+    return stops;
+  }
+
+  SeenStops &seen_stops = GetSeenStops();
+  seen_stops.Reset(keys_.size());
+  auto add_stop = [&stops, &seen_stops, limit](StopId stop) {
+    if (stops.size() < limit && seen_stops.Mark(stop)) {
+      stops.push_back(stop);
+    }
+  };
+
+  // Названия, начинающиеся с запроса
+  for (auto it = std::lower_bound(data_.stops.begin(), data_.stops.end(), key,
+      [this](StopId stop, const Key &key) {
+        return keys_[stop] < key;
+      });
+    it != data_.stops.end() && stops.size() < limit
+      && StartsWith(keys_[*it], key); ++it) {
+    add_stop(*it);
+  }
+
+  // Названия со словом, начинающимся с запроса
+  for (auto it = std::lower_bound(data_.words.begin(), data_.words.end(), key,
+      [this](const WordEntry &word, const Key &key) {
+        return GetSuffix(word) < std::u32string_view(key);
+      });
+    it != data_.words.end() && stops.size() < limit
+      && StartsWith(GetSuffix(*it), key); ++it) {
+    add_stop(it->stop);
+  }
+
+  if (stops.size() == limit || key.size() < MIN_FUZZY_QUERY_LENGTH) {
+    return stops;
+  }
+
+  // Названия или слова в них, начинающиеся с запроса с опечатками
+  const size_t max_errors = key.size() < MIN_TWO_ERRORS_QUERY_LENGTH ? 1 : 2;
+  std::vector<std::pair<size_t, StopId>> candidates;
+  FuzzyMatcher matcher(key, max_errors);
+  matcher.AddCandidates(data_.stops,
+    [this](StopId stop) {
+      return std::u32string_view(keys_[stop]);
+    },
+    [](StopId stop) {
+      return stop;
+    }, candidates);
+  matcher.AddCandidates(data_.words,
+    [this](const WordEntry &word) {
+      return GetSuffix(word);
+    },
+    [](const WordEntry &word) {
+      return word.stop;
+    }, candidates);
+  std::stable_sort(candidates.begin(), candidates.end(),
+    [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+  for (const auto &[distance, stop] : candidates) {
+    add_stop(stop);
+  }
+
+  return stops;
+}
+
+const StopSearch::StopSearchData &StopSearch::GetStopSearchData() const {
+  return data_;
+}
+
+// Кодовые точки декодируются из UTF-8 без проверки корректности: названия
+// приходят из разобранного JSON
+StopSearch::Key StopSearch::Normalize(std::string_view name) {
+  Key key;
+  key.reserve(name.size());
+
+  for (size_t i = 0; i < name.size();) {
+    const auto byte = static_cast<unsigned char>(name[i]);
+    char32_t c = byte;
+    size_t length = 1;
+    if (byte >= 0xF0) {
+      c = byte & 0x07;
+      length = 4;
+    } else if (byte >= 0xE0) {
+      c = byte & 0x0F;
+      length = 3;
+    } else if (byte >= 0xC0) {
+      c = byte & 0x1F;
+      length = 2;
+    }
+
+    if (i + length > name.size()) {
+      c = byte;
+      length = 1;
+    }
+    for (size_t k = 1; k < length; ++k) {
+      c = (c << 6) | (static_cast<unsigned char>(name[i + k]) & 0x3F);
+    }
+
+    key.push_back(ToLower(c));
+    i += length;
+  }
+
+  return key;
+}
+
+// Разделители слов: знаки препинания и пробелы ASCII, неразрывный пробел,
+// кавычки-ёлочки, дефисы, тире и типографские кавычки
+bool StopSearch::IsSeparator(char32_t c) {
+  if (c < 0x80) {
+    return !((c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z')
+      || (c >= U'0' && c <= U'9'));
+  }
+  return c == U' ' || c == U'«' || c == U'»'
+    || (c >= U'‐' && c <= U'‟');
+}
+
+std::u32string_view StopSearch::GetSuffix(const WordEntry &word) const {
+  return std::u32string_view(keys_[word.stop]).substr(word.offset);
+}
+
+} // namespace tc
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "domain.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tc {
+
+// Подсказки остановок по началу слова названия. Названия приводятся к нижнему
+// регистру по кодовым точкам UTF-8 (латиница и кириллица, "ё" заменяется на
+// "е"). Остановки упорядочены по названиям, а начала остальных слов - по
+// суффиксам названий с этих слов, поэтому совпадения с началом названия и
+// с началом слова находятся двоичным поиском и выдаются без сортировки.
+// Если совпадений меньше запрошенного числа, они дополняются названиями,
+// слово которых начинается с запроса с одной-двумя опечатками. Для этого
+// упорядоченные массивы обходятся как префиксное дерево: столбцы таблицы
+// расстояний редактирования общего начала соседних строк не пересчитываются,
+// а строки с началом, уже далёким от запроса, пропускаются
+class StopSearch {
+public:
+  struct WordEntry {
+    StopId stop{};
+    uint32_t offset{};  // Номер первой кодовой точки слова в названии
+  };
+
+  struct StopSearchData {
+    std::vector<StopId> stops;     // По приведённым названиям
+    std::vector<WordEntry> words;  // Слова после первого, по суффиксам
+  };
+
+  StopSearch() = default;
+
+  // names - названия остановок по номерам
+  explicit StopSearch(const std::vector<std::string_view> &names);
+
+  // Восстанавливает индекс по сохранённому порядку. Приведённые названия
+  // вычисляются заново за линейное время
+  StopSearch(const std::vector<std::string_view> &names, StopSearchData data);
+
+  // Не более limit остановок: сначала названия, начинающиеся с запроса, затем
+  // названия со словом, начинающимся с запроса, затем близкие по опечаткам
+  std::vector<StopId> Find(std::string_view query, size_t limit) const;
+
+  const StopSearchData &GetStopSearchData() const;
+
+private:
+  using Key = std::u32string;
+
+  static Key Normalize(std::string_view name);
+  static bool IsSeparator(char32_t c);
+
+  std::u32string_view GetSuffix(const WordEntry &word) const;
+
+  std::vector<Key> keys_;  // По номерам остановок
+  StopSearchData data_;
+};
+
+} // namespace tc
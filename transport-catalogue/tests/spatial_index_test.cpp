@@ -0,0 +1,89 @@
+#include "geo.h"
+#include "spatial_index.h"
+#include "test_framework.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace tc {
+
+namespace {
+
+// Сдвиг по широте на заданное число метров к северу
+geo::Coordinates MoveNorth(geo::Coordinates coordinates, double meters) {
+  static const double dr = 3.1415926535 / 180.;
+  coordinates.lat += meters / (geo::r_Earth * dr);
+  return coordinates;
+}
+
+void TestFindsStopNextToQueryPoint() {
+  const std::vector<geo::Coordinates> coordinates{
+    {55.611087, 37.20829},
+    {55.500805, 37.202415},
+    {55.595884, 37.209755}
+  };
+  const SpatialIndex index(coordinates);
+
+  for (const double offset : {0.0, 1e-4, 1e-2, 1.0}) {
+    const auto nearest = index.FindNearest(
+      MoveNorth(coordinates[1], offset), 10.0, 1);
+    const auto hint = "offset "s + std::to_string(offset);
+    ASSERT_EQUAL_HINT(nearest.size(), 1u, hint);
+    ASSERT_EQUAL_HINT(nearest.front().stop, 1u, hint);
+    ASSERT_NEAR_HINT(nearest.front().distance, offset, 1e-3, hint);
+  }
+}
+
+void TestMatchesBruteForce() {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> lat(55.5, 55.9);
+  std::uniform_real_distribution<double> lng(37.3, 37.9);
+
+  std::vector<geo::Coordinates> coordinates(1000);
+  for (auto &stop_coordinates : coordinates) {
+    stop_coordinates = {lat(generator), lng(generator)};
+  }
+  const SpatialIndex index(coordinates);
+  const SpatialIndex restored(coordinates, index.GetSpatialIndexData());
+
+  for (int i = 0; i < 200; ++i) {
+    const geo::Coordinates point{lat(generator), lng(generator)};
+    const double radius = 2000.0;
+    const size_t count = 5;
+
+    std::vector<double> expected;
+    for (const auto &stop_coordinates : coordinates) {
+      const double distance = geo::ComputeDistance(point, stop_coordinates);
+      if (distance <= radius) {
+        expected.push_back(distance);
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+    // Остановки на самой границе круга могут разойтись из-за округления
+    while (!expected.empty() && expected.back() > radius - 1e-3) {
+      expected.pop_back();
+    }
+    expected.resize(std::min(expected.size(), count));
+
+    for (const SpatialIndex *tree : {&index, &restored}) {
+      const auto nearest = tree->FindNearest(point, radius, count);
+      ASSERT(nearest.size() >= expected.size());
+      for (size_t j = 0; j < expected.size(); ++j) {
+        ASSERT_NEAR(nearest[j].distance, expected[j], 1e-3);
+      }
+    }
+  }
+}
+
+} // namespace
+
+} // namespace tc
+
+int main() {
+  RUN_TEST(tc::TestFindsStopNextToQueryPoint);
+  RUN_TEST(tc::TestMatchesBruteForce);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace test {
+
+template <typename T, typename U>
+void AssertEqualImpl(const T &t, const U &u, const std::string &t_str,
+  const std::string &u_str, const std::string &file, const std::string &func,
+  unsigned line, const std::string &hint) {
+  using namespace std::string_literals;
+
+  if (t != u) {
+    std::cerr << std::boolalpha;
+    std::cerr << file << "("s << line << "): "s << func << ": "s;
+    std::cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
+    std::cerr << t << " != "s << u << "."s;
+    if (!hint.empty()) {
+      std::cerr << " Hint: "s << hint;
+    }
+    std::cerr << std::endl;
+    std::abort();
+  }
+}
+
+inline void AssertNearImpl(double t, double u, double tolerance,
+  const std::string &t_str, const std::string &u_str, const std::string &file,
+  const std::string &func, unsigned line, const std::string &hint) {
+  using namespace std::string_literals;
+
+  if (!(std::abs(t - u) <= tolerance)) {
+    std::cerr << file << "("s << line << "): "s << func << ": "s;
+    std::cerr << "ASSERT_NEAR("s << t_str << ", "s << u_str << ") failed: "s;
+    std::cerr << t << " != "s << u << "."s;
+    if (!hint.empty()) {
+      std::cerr << " Hint: "s << hint;
+    }
+    std::cerr << std::endl;
+    std::abort();
+  }
+}
+
+inline void AssertImpl(bool value, const std::string &expr_str,
+  const std::string &file, const std::string &func, unsigned line,
+  const std::string &hint) {
+  using namespace std::string_literals;
+
+  if (!value) {
+    std::cerr << file << "("s << line << "): "s << func << ": "s;
+    std::cerr << "ASSERT("s << expr_str << ") failed."s;
+    if (!hint.empty()) {
+      std::cerr << " Hint: "s << hint;
+    }
+    std::cerr << std::endl;
+    std::abort();
+  }
+}
+
+template <typename TestFunc>
+void RunTestImpl(const TestFunc &func, const std::string &test_name) {
+  func();
+  std::cerr << test_name << " OK" << std::endl;
+}
+
+} // namespace test
+
+#define ASSERT_EQUAL(a, b) test::AssertEqualImpl((a), (b), #a, #b, \
+  __FILE__, __FUNCTION__, __LINE__, "")
+
+#define ASSERT_EQUAL_HINT(a, b, hint) test::AssertEqualImpl((a), (b), #a, #b, \
+  __FILE__, __FUNCTION__, __LINE__, (hint))
+
+#define ASSERT_NEAR(a, b, tolerance) test::AssertNearImpl((a), (b), \
+  (tolerance), #a, #b, __FILE__, __FUNCTION__, __LINE__, "")
+
+#define ASSERT_NEAR_HINT(a, b, tolerance, hint) test::AssertNearImpl((a), \
+  (b), (tolerance), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+#define ASSERT(expr) test::AssertImpl(!!(expr), #expr, __FILE__, \
+  __FUNCTION__, __LINE__, "")
+
+#define ASSERT_HINT(expr, hint) test::AssertImpl(!!(expr), #expr, __FILE__, \
+  __FUNCTION__, __LINE__, (hint))
+
+#define RUN_TEST(func) test::RunTestImpl((func), #func)
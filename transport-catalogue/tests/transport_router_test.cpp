@@ -0,0 +1,233 @@
+#include "test_framework.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <chrono>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+using namespace std::string_literals;
+
+namespace tc::router {
+
+namespace {
+
+const double TIME_TOLERANCE = 1e-6;
+
+struct Network {
+  struct Route {
+    std::vector<StopId> stops;
+    bool is_roundtrip;
+  };
+
+  size_t stop_count = 0;
+  std::vector<geo::Coordinates> coordinates;
+  // Расстояния между соседними остановками маршрутов: from, to, метры
+  std::vector<std::tuple<StopId, StopId, int>> distances;
+  std::vector<Route> routes;
+};
+
+// Случайная сеть: остановки в квадрате около 10 км, маршруты из случайных
+// остановок, дорожные расстояния не зависят от координат и могут различаться
+// в разные стороны
+Network MakeRandomNetwork(std::mt19937 &generator) {
+  std::uniform_real_distribution<double> lat(55.60, 55.70);
+  std::uniform_real_distribution<double> lng(37.50, 37.65);
+  std::uniform_int_distribution<int> distance(200, 5000);
+  std::uniform_int_distribution<size_t> stop_count(2, 40);
+  std::uniform_int_distribution<size_t> route_count(1, 12);
+  std::uniform_int_distribution<size_t> route_size(2, 8);
+  std::bernoulli_distribution coin;
+
+  Network network;
+  network.stop_count = stop_count(generator);
+  for (size_t i = 0; i < network.stop_count; ++i) {
+    network.coordinates.push_back({lat(generator), lng(generator)});
+  }
+
+  std::uniform_int_distribution<StopId> stop(0, network.stop_count - 1);
+  const size_t count = route_count(generator);
+  for (size_t i = 0; i < count; ++i) {
+    Network::Route route;
+    route.is_roundtrip = coin(generator);
+    const size_t size = route_size(generator);
+    route.stops.push_back(stop(generator));
+    while (route.stops.size() < size) {
+      const StopId next = stop(generator);
+      if (next == route.stops.back()) {
+        continue;
+      }
+      network.distances.emplace_back(route.stops.back(), next,
+        distance(generator));
+      if (coin(generator)) {
+        network.distances.emplace_back(next, route.stops.back(),
+          distance(generator));
+      }
+      route.stops.push_back(next);
+    }
+    if (route.is_roundtrip && route.stops.back() != route.stops.front()) {
+      network.distances.emplace_back(route.stops.back(), route.stops.front(),
+        distance(generator));
+      route.stops.push_back(route.stops.front());
+    }
+    network.routes.push_back(std::move(route));
+  }
+
+  return network;
+}
+
+// skip_route - номер маршрута, не попадающего в справочник
+void FillCatalogue(TransportCatalogue &cat, const Network &network,
+  std::optional<size_t> skip_route = std::nullopt) {
+  for (size_t i = 0; i < network.stop_count; ++i) {
+    cat.AddStop("Stop "s + std::to_string(i), network.coordinates[i]);
+  }
+  for (const auto &[from, to, distance] : network.distances) {
+    cat.SetDistance(from, to, distance);
+  }
+  for (size_t i = 0; i < network.routes.size(); ++i) {
+    if (i != skip_route) {
+      cat.AddRoute("Bus "s + std::to_string(i), network.routes[i].stops,
+        network.routes[i].is_roundtrip);
+    }
+  }
+
+  cat.BuildNameIndexes();
+  cat.BuildStopSearch();
+  cat.BuildSpatialIndex();
+}
+
+RoutingSettings MakeSettings(RouterType router_type) {
+  RoutingSettings settings;
+  settings.bus_wait_time = std::chrono::minutes(4);
+  settings.bus_velocity = 32;
+  settings.router_type = router_type;
+  settings.thread_count = 1;
+  settings.landmark_count = 4;
+  return settings;
+}
+
+// Время в пути по описанию маршрута
+Minutes SumItemTimes(const RouteInfo &route) {
+  Minutes total_time{};
+  for (const auto &item : route.items) {
+    std::visit([&total_time](const auto &value) {
+      total_time += value.time;
+    }, item);
+  }
+  return total_time;
+}
+
+std::string MakeHint(RouterType router_type, const Stop &from,
+  const Stop &to) {
+  return "router type "s + std::to_string(static_cast<int>(router_type))
+    + ", "s + from.name + " -> "s + to.name;
+}
+
+void AssertSameTime(const std::optional<Minutes> &actual,
+  const std::optional<RouteInfo> &expected, const std::string &hint) {
+  ASSERT_EQUAL_HINT(actual.has_value(), expected.has_value(), hint);
+  if (actual) {
+    ASSERT_NEAR_HINT(actual->count(), expected->total_time.count(),
+      TIME_TOLERANCE, hint);
+  }
+}
+
+const RouterType ROUTER_TYPES[] = {
+  RouterType::ALL_PAIRS,
+  RouterType::DIJKSTRA,
+  RouterType::CONTRACTION_HIERARCHY,
+  RouterType::RAPTOR,
+  RouterType::A_STAR,
+  RouterType::BIDIRECTIONAL_A_STAR,
+  RouterType::ALT,
+  RouterType::AUTO,
+};
+
+// Все пары остановок случайных сетей: движок находит маршрут тогда же, когда
+// поиск Дейкстры, и с тем же временем в пути
+void TestMatchesDijkstra(RouterType router_type) {
+  std::mt19937 generator(static_cast<unsigned>(router_type) + 1);
+
+  for (int iteration = 0; iteration < 30; ++iteration) {
+    const Network network = MakeRandomNetwork(generator);
+    TransportCatalogue cat;
+    FillCatalogue(cat, network);
+
+    const TransportRouter dijkstra(MakeSettings(RouterType::DIJKSTRA), cat);
+    auto settings = MakeSettings(router_type);
+    settings.hub_labels = iteration % 2 == 1;
+    const TransportRouter router(settings, cat);
+
+    for (const auto &from : cat.GetStops()) {
+      for (const auto &to : cat.GetStops()) {
+        const auto hint = MakeHint(router_type, from, to);
+        const auto expected = dijkstra.FindRoute(&from, &to);
+        const auto route = router.FindRoute(&from, &to);
+        AssertSameTime(route
+          ? std::optional<Minutes>(route->total_time) : std::nullopt,
+          expected, hint);
+        if (route) {
+          ASSERT_NEAR_HINT(SumItemTimes(*route).count(),
+            route->total_time.count(), TIME_TOLERANCE, hint);
+        }
+
+        AssertSameTime(router.FindRouteTime(&from, &to), expected, hint);
+      }
+    }
+  }
+}
+
+// Закрытый автобус: маршруты такие же, как в справочнике без него
+void TestClosedBusMatchesCatalogueWithoutIt(RouterType router_type) {
+  std::mt19937 generator(static_cast<unsigned>(router_type) + 101);
+
+  for (int iteration = 0; iteration < 20; ++iteration) {
+    const Network network = MakeRandomNetwork(generator);
+    const size_t closed_route = std::uniform_int_distribution<size_t>(
+      0, network.routes.size() - 1)(generator);
+
+    TransportCatalogue cat;
+    FillCatalogue(cat, network);
+    TransportCatalogue reduced_cat;
+    FillCatalogue(reduced_cat, network, closed_route);
+
+    TransportRouter router(MakeSettings(router_type), cat);
+    Closures closures;
+    closures.buses.insert(&cat.GetBus(static_cast<BusId>(closed_route)));
+    router.SetClosures(std::move(closures));
+    const TransportRouter dijkstra(MakeSettings(RouterType::DIJKSTRA),
+      reduced_cat);
+
+    for (StopId from = 0; from < network.stop_count; ++from) {
+      for (StopId to = 0; to < network.stop_count; ++to) {
+        const auto expected = dijkstra.FindRoute(&reduced_cat.GetStop(from),
+          &reduced_cat.GetStop(to));
+        const auto route = router.FindRoute(&cat.GetStop(from),
+          &cat.GetStop(to));
+        AssertSameTime(route
+          ? std::optional<Minutes>(route->total_time) : std::nullopt,
+          expected, MakeHint(router_type, cat.GetStop(from), cat.GetStop(to)));
+      }
+    }
+  }
+}
+
+void TestAllRouterTypes() {
+  for (const RouterType router_type : ROUTER_TYPES) {
+    TestMatchesDijkstra(router_type);
+    TestClosedBusMatchesCatalogueWithoutIt(router_type);
+  }
+}
+
+} // namespace
+
+} // namespace tc::router
+
+int main() {
+  RUN_TEST(tc::router::TestAllRouterTypes);
+}
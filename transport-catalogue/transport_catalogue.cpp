@@ -1,123 +1,269 @@
-#include "geo.h"
 #include "transport_catalogue.h"
 
+#include <algorithm>
 #include <unordered_set>
+#include <utility>
 
 namespace tc {
 
-void TransportCatalogue::AddStop(Stop stop) {
-  auto &ref = stops_.emplace_back(std::move(stop.name),
-    stop.lat, stop.lng);
+namespace {
 
-  name_to_stop_[ref.name] = &ref;
+// Первое расстояние до остановки с номером не меньше to
+template <typename Iterator>
+Iterator LowerBoundByStop(Iterator begin, Iterator end, StopId to) {
+  return std::lower_bound(begin, end, to,
+    [](const RoadDistance &lhs, StopId rhs) {
+      return lhs.to < rhs;
+    });
 }
 
-void TransportCatalogue::AddRoute(Bus bus) {
-  // Помещение оригинала автобуса в список (постоянное хранилище)
-  auto &ref = buses_.emplace_back(std::move(bus.name), bus.stops,
-    bus.final_stops);
+// Имена, добавленные после построения индекса, хранятся в ассоциативном
+// массиве и проверяются первыми. Остальные имена находятся одним хешем
+// индекса и одним сравнением
+template <typename Item>
+const Item *FindByName(std::string_view name,
+  const std::unordered_map<std::string_view, const Item *> &name_to_item,
+  const NameIndex &index, const std::deque<Item> &items) {
+  if (!name_to_item.empty()) {
+    if (const auto it = name_to_item.find(name); it != name_to_item.end()) {
+      return it->second;
+    }
+  }
+
+  const auto id = index.Find(name);
+  if (id && *id < items.size() && items[*id].name == name) {
+    return &items[*id];
+  }
+
+  return nullptr;
+}
+
+} // namespace
+
+StopId TransportCatalogue::AddStop(std::string name,
+  geo::Coordinates coordinates) {
+  const auto id = static_cast<StopId>(stops_.size());
+  auto &ref = stops_.emplace_back(std::move(name), id);
+
+  latitudes_.push_back(coordinates.lat);
+  longitudes_.push_back(coordinates.lng);
+  stop_buses_.emplace_back();
+  distances_.emplace_back();
+  if (id >= stop_name_index_.GetNameCount()) {
+    name_to_stop_[ref.name] = &ref;
+  }
+
+  return id;
+}
+
+BusId TransportCatalogue::AddRoute(std::string name,
+  const std::vector<StopId> &stops, bool is_roundtrip) {
+  const auto id = static_cast<BusId>(buses_.size());
+  const size_t route_offset = route_stops_.size();
+
+  // Определение конечных остановок
+  std::vector<StopId> final_stops;
+  if (!stops.empty()) {
+    final_stops.push_back(stops.front());
+    if (stops.front() != stops.back()) {
+      final_stops.push_back(stops.back());
+    }
+  }
+
+  // Приведение маршрута вида "stop1 - stop2 - ... stopN" к виду
+  // "stop1 > stop2 > ... > stopN-1 > stopN > stopN-1 > ... > stop2 > stop1"
+  route_stops_.insert(route_stops_.end(), stops.begin(), stops.end());
+  if (!is_roundtrip && !stops.empty()) {
+    route_stops_.insert(route_stops_.end(), stops.rbegin() + 1, stops.rend());
+  }
+
+  auto &ref = buses_.emplace_back(std::move(name), id, is_roundtrip, route_offset,
+    route_stops_.size() - route_offset, std::move(final_stops));
 
   // Добавление текущего автобуса ко всем остановкам, через которые он проезжает
-  for (const auto stop : bus.stops) {
-    stop_to_buses_[stop->name].insert(&ref);
+  const auto route = GetRoute(id);
+  for (const StopId stop : route) {
+    stop_buses_[stop].insert(&ref);
   }
 
-  // Добавление автобуса в ассоциативный массив для поиска по имени
-  name_to_bus_[ref.name] = &ref;
+  // Добавление автобуса в ассоциативный массив для поиска по имени, если
+  // индекс имён его не учитывает
+  if (id >= bus_name_index_.GetNameCount()) {
+    name_to_bus_[ref.name] = &ref;
+  }
 
   BusInfo info;
   double fact_route_length = 0, line_route_length = 0;
-  Route &route = bus.stops;
 
   // Уникальные остановки
-  std::unordered_set<Stop *> unique_stops(route.begin(), route.end());
+  std::unordered_set<StopId> unique_stops(route.begin(), route.end());
 
-  // Расчёт длины маршрута по координатам
-  for (size_t i = 0; i < route.size() - 1; ++i) {
-    geo::Coordinates first = {(*route[i]).lat, (*route[i]).lng};
-    geo::Coordinates second = {(*route[i + 1]).lat, (*route[i + 1]).lng};
-    line_route_length += ComputeDistance(first, second);
+  const StopId *route_stops = route.begin();
+  for (size_t i = 1; i < ref.route_size; ++i) {
+    // Расчёт длины маршрута по координатам
+    line_route_length += ComputeDistance(GetCoordinates(route_stops[i - 1]),
+      GetCoordinates(route_stops[i]));
+    // Рассчёт длины маршрута по заданным пользователем значениям
+    fact_route_length += GetDistance(route_stops[i - 1], route_stops[i]);
   }
 
-  // Рассчёт длины маршрута по заданным пользователем значениям
-  for (size_t i = 0; i < route.size() - 1; ++i) {
-    fact_route_length += GetDistance(route[i], route[i + 1]);
-  }
-
-  info.total_stops = route.size();
+  info.total_stops = ref.route_size;
   info.unique_stops = unique_stops.size();
   info.fact_route_length = fact_route_length;
   info.line_route_length = line_route_length;
 
-  bus_to_info_[&ref] = info;
+  bus_infos_.push_back(info);
+
+  return id;
 }
 
-void TransportCatalogue::SetDistance(std::pair<Stop *, Stop *> &stops,
-  int distance) {
-  distances_[stops] = distance;
+void TransportCatalogue::SetDistance(StopId from, StopId to, int distance) {
+  auto &distances = distances_[from];
+  const auto it = LowerBoundByStop(distances.begin(), distances.end(), to);
+
+  if (it != distances.end() && it->to == to) {
+    it->distance = distance;
+  } else {
+    distances.insert(it, {to, distance});
+  }
 }
 
-int TransportCatalogue::GetDistance(Stop *a, Stop *b) const {
+int TransportCatalogue::GetDistance(StopId a, StopId b) const {
   // Расстояние от А до Б
-  auto it = distances_.find({a, b});
-
-  if (it == distances_.end()) {
-    // Расстояние от Б до А
-    it = distances_.find({b, a});
-    if (it == distances_.end()) {
-      return -1;
-    }
+  if (const auto distance = FindDistance(a, b)) {
+    return *distance;
   }
 
-  return it->second;
+  // Расстояние от Б до А
+  return FindDistance(b, a).value_or(-1);
+}
+
+const RoadDistances &TransportCatalogue::GetDistancesFrom(StopId from) const {
+  return distances_[from];
 }
 
-std::unordered_map<std::pair<Stop *, Stop *>, int, Hasher>
-TransportCatalogue::GetDistances() const {
-  return distances_;
+const Stop *TransportCatalogue::GetStop(const std::string_view name) const {
+  return FindByName(name, name_to_stop_, stop_name_index_, stops_);
 }
 
-Stop *TransportCatalogue::GetStop(const std::string_view name) const {
-  auto it = name_to_stop_.find(name);
+const Bus *TransportCatalogue::GetBus(const std::string_view name) const {
+  return FindByName(name, name_to_bus_, bus_name_index_, buses_);
+}
+
+const Stop &TransportCatalogue::GetStop(StopId id) const {
+  return stops_[id];
+}
 
-  if (it != name_to_stop_.end()) {
-    return it->second;
+const Bus &TransportCatalogue::GetBus(BusId id) const {
+  return buses_[id];
+}
+
+geo::Coordinates TransportCatalogue::GetCoordinates(StopId id) const {
+  return {latitudes_[id], longitudes_[id]};
+}
+
+RouteRange TransportCatalogue::GetRoute(BusId id) const {
+  const Bus &bus = buses_[id];
+  const StopId *begin = route_stops_.data() + bus.route_offset;
+
+  return {begin, begin + bus.route_size};
+}
+
+const BusInfo &TransportCatalogue::GetBusInfo(BusId id) const {
+  return bus_infos_[id];
+}
+
+const Buses &TransportCatalogue::GetBusesByStop(StopId id) const {
+  return stop_buses_[id];
+}
+
+const std::deque<Bus> &TransportCatalogue::GetBuses() const {
+  return buses_;
+}
+
+const std::deque<Stop> &TransportCatalogue::GetStops() const {
+  return stops_;
+}
+
+void TransportCatalogue::BuildNameIndexes() {
+  std::vector<std::string_view> stop_names;
+  stop_names.reserve(stops_.size());
+  for (const auto &stop : stops_) {
+    stop_names.push_back(stop.name);
   }
 
-  return nullptr;
+  std::vector<std::string_view> bus_names;
+  bus_names.reserve(buses_.size());
+  for (const auto &bus : buses_) {
+    bus_names.push_back(bus.name);
+  }
+
+  stop_name_index_ = NameIndex(stop_names);
+  bus_name_index_ = NameIndex(bus_names);
+  name_to_stop_.clear();
+  name_to_bus_.clear();
+}
+
+void TransportCatalogue::SetNameIndexes(NameIndex stop_name_index,
+  NameIndex bus_name_index) {
+  stop_name_index_ = std::move(stop_name_index);
+  bus_name_index_ = std::move(bus_name_index);
 }
 
-Bus *TransportCatalogue::GetBus(const std::string_view name) const {
-  auto it = name_to_bus_.find(name);
+const NameIndex &TransportCatalogue::GetStopNameIndex() const {
+  return stop_name_index_;
+}
+
+const NameIndex &TransportCatalogue::GetBusNameIndex() const {
+  return bus_name_index_;
+}
 
-  if (it != name_to_bus_.end()) {
-    return it->second;
+void TransportCatalogue::BuildStopSearch() {
+  std::vector<std::string_view> names;
+  names.reserve(stops_.size());
+  for (const auto &stop : stops_) {
+    names.push_back(stop.name);
   }
 
-  return nullptr;
+  stop_search_ = StopSearch(names);
 }
 
-BusInfo TransportCatalogue::GetBusInfo(Bus *bus) const {
-  return bus_to_info_.at(bus);
+void TransportCatalogue::SetStopSearch(StopSearch stop_search) {
+  stop_search_ = std::move(stop_search);
 }
 
-const Buses &TransportCatalogue::GetBusesByStop(std::string_view name) const {
-  static const std::set<Bus *, BusPtrComparator> empty;
-  auto it = stop_to_buses_.find(name);
+const StopSearch &TransportCatalogue::GetStopSearch() const {
+  return stop_search_;
+}
 
-  if (it != stop_to_buses_.end()) {
-    return it->second;
+void TransportCatalogue::BuildSpatialIndex() {
+  std::vector<geo::Coordinates> coordinates;
+  coordinates.reserve(stops_.size());
+  for (StopId id = 0; id < stops_.size(); ++id) {
+    coordinates.push_back(GetCoordinates(id));
   }
 
-  return empty;
+  spatial_index_ = SpatialIndex(coordinates);
 }
 
-const std::list<Bus> &TransportCatalogue::GetBuses() const {
-  return buses_;
+void TransportCatalogue::SetSpatialIndex(SpatialIndex spatial_index) {
+  spatial_index_ = std::move(spatial_index);
 }
 
-const std::list<Stop> &TransportCatalogue::GetStops() const {
-  return stops_;
+const SpatialIndex &TransportCatalogue::GetSpatialIndex() const {
+  return spatial_index_;
+}
+
+std::optional<int> TransportCatalogue::FindDistance(StopId from,
+  StopId to) const {
+  const auto &distances = distances_[from];
+  const auto it = LowerBoundByStop(distances.begin(), distances.end(), to);
+
+  if (it != distances.end() && it->to == to) {
+    return it->distance;
+  }
+
+  return std::nullopt;
 }
 
 } // namespace tc
@@ -1,40 +1,105 @@
 #pragma once
 
 #include "domain.h"
+#include "geo.h"
+#include "name_index.h"
+#include "ranges.h"
+#include "spatial_index.h"
+#include "stop_search.h"
 
-#include <list>
+#include <deque>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <utility>
 
 namespace tc {
 
+// Остановки маршрута автобуса подряд в общем массиве справочника
+using RouteRange = ranges::Range<const StopId *>;
+
+// Дорожное расстояние от остановки до соседней остановки to
+struct RoadDistance {
+  StopId to{};
+  int distance{};
+};
+
+// Расстояния от одной остановки, упорядоченные по номеру соседней остановки
+using RoadDistances = std::vector<RoadDistance>;
+
+// Остановки и автобусы хранятся в деках: адреса элементов не меняются при
+// добавлении, а поиск по номеру сводится к индексации. Координаты остановок,
+// маршруты, дорожные расстояния и сведения об автобусах лежат в отдельных
+// плотных массивах по номерам
 class TransportCatalogue {
 public:
-  void AddStop(Stop stop);
-  void AddRoute(Bus bus);
-  void SetDistance(std::pair<Stop *, Stop *> &stops, int distance);
-
-  Stop *GetStop(std::string_view name) const;
-  Bus *GetBus(std::string_view name) const;
-  BusInfo GetBusInfo(Bus *bus) const;
-  const Buses &GetBusesByStop(std::string_view name) const;
-  int GetDistance(Stop *a, Stop *b) const;
-  std::unordered_map<std::pair<Stop *, Stop *>, int, Hasher>
-  GetDistances() const;
-  const std::list<Bus> &GetBuses() const;
-  const std::list<Stop> &GetStops() const;
+  StopId AddStop(std::string name, geo::Coordinates coordinates);
+
+  // Маршрут некольцевого автобуса задаётся в одну сторону и дополняется
+  // обратным путём. Расстояния между остановками должны быть заданы заранее
+  BusId AddRoute(std::string name, const std::vector<StopId> &stops,
+    bool is_roundtrip);
+
+  void SetDistance(StopId from, StopId to, int distance);
+
+  // Строит индексы имён остановок и автобусов после заполнения справочника.
+  // Ассоциативные массивы имён после этого хранят только имена, добавленные
+  // позже
+  void BuildNameIndexes();
+
+  // Восстанавливает индексы имён. Вызывается до добавления остановок и
+  // автобусов, чтобы не заполнять ассоциативные массивы имён
+  void SetNameIndexes(NameIndex stop_name_index, NameIndex bus_name_index);
+
+  const NameIndex &GetStopNameIndex() const;
+  const NameIndex &GetBusNameIndex() const;
+
+  // Строит индекс подсказок по названиям остановок. Остановки, добавленные
+  // позже, в подсказки не попадают
+  void BuildStopSearch();
+  void SetStopSearch(StopSearch stop_search);
+  const StopSearch &GetStopSearch() const;
+
+  // Строит пространственный индекс остановок. Остановки, добавленные позже,
+  // в него не попадают
+  void BuildSpatialIndex();
+  void SetSpatialIndex(SpatialIndex spatial_index);
+  const SpatialIndex &GetSpatialIndex() const;
+
+  const Stop *GetStop(std::string_view name) const;
+  const Bus *GetBus(std::string_view name) const;
+  const Stop &GetStop(StopId id) const;
+  const Bus &GetBus(BusId id) const;
+  geo::Coordinates GetCoordinates(StopId id) const;
+  RouteRange GetRoute(BusId id) const;
+  const BusInfo &GetBusInfo(BusId id) const;
+  const Buses &GetBusesByStop(StopId id) const;
+  // Расстояние от А до Б, а если оно не задано - от Б до А. Возвращает -1,
+  // если не задано ни одно из них
+  int GetDistance(StopId a, StopId b) const;
+  // Заданные расстояния от остановки без копирования
+  const RoadDistances &GetDistancesFrom(StopId from) const;
+  const std::deque<Bus> &GetBuses() const;
+  const std::deque<Stop> &GetStops() const;
 
 private:
-  std::list<Stop> stops_;
-  std::list<Bus> buses_;
-  std::unordered_map<std::string_view, Stop *> name_to_stop_;
-  std::unordered_map<std::string_view, Bus *> name_to_bus_;
-  std::unordered_map<std::string_view, Buses> stop_to_buses_;
-  std::unordered_map<Bus *, BusInfo, Hasher> bus_to_info_;
-  std::unordered_map<std::pair<Stop *, Stop *>, int, Hasher> distances_;
+  std::optional<int> FindDistance(StopId from, StopId to) const;
+
+  std::deque<Stop> stops_;
+  std::deque<Bus> buses_;
+  std::vector<double> latitudes_;
+  std::vector<double> longitudes_;
+  std::vector<StopId> route_stops_;
+  std::vector<BusInfo> bus_infos_;
+  std::vector<Buses> stop_buses_;
+  NameIndex stop_name_index_;
+  NameIndex bus_name_index_;
+  StopSearch stop_search_;
+  SpatialIndex spatial_index_;
+  std::unordered_map<std::string_view, const Stop *> name_to_stop_;
+  std::unordered_map<std::string_view, const Bus *> name_to_bus_;
+  std::vector<RoadDistances> distances_;
 };
 
 } // namespace tc
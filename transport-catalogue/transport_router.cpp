@@ -1,8 +1,68 @@
+#include "geo.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <thread>
+
 namespace tc::router {
 
+namespace {
+
+// Номер точки решётки 2^16 x 2^16 вдоль кривой Гильберта. Близкие номера
+// получают близкие точки
+uint64_t GetHilbertIndex(uint32_t x, uint32_t y) {
+  constexpr uint32_t side = 1u << 16;
+  uint64_t index = 0;
+  for (uint32_t half = side / 2; half > 0; half /= 2) {
+    const uint32_t rx = (x & half) != 0 ? 1 : 0;
+    const uint32_t ry = (y & half) != 0 ? 1 : 0;
+    index += static_cast<uint64_t>(half) * half * ((3 * rx) ^ ry);
+
+    // Поворот четверти, чтобы кривая внутри неё шла в нужном направлении
+    if (ry == 0) {
+      if (rx == 1) {
+        x = side - 1 - x;
+        y = side - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return index;
+}
+
+std::string_view GetRouterTypeName(RouterType router_type) {
+  using namespace std::string_view_literals;
+
+  switch (router_type) {
+    case RouterType::ALL_PAIRS:
+      return "all_pairs"sv;
+    case RouterType::DIJKSTRA:
+      return "dijkstra"sv;
+    case RouterType::CONTRACTION_HIERARCHY:
+      return "contraction_hierarchy"sv;
+    case RouterType::RAPTOR:
+      return "raptor"sv;
+    case RouterType::A_STAR:
+      return "a_star"sv;
+    case RouterType::BIDIRECTIONAL_A_STAR:
+      return "bidirectional_a_star"sv;
+    case RouterType::ALT:
+      return "alt"sv;
+    case RouterType::AUTO:
+      break;
+  }
+  return "auto"sv;
+}
+
+}  // namespace
+
 TransportRouter::TransportRouter(RoutingSettings settings, const TransportCatalogue &cat)
   : settings_(settings) {
   const auto &stops = cat.GetStops();
@@ -10,14 +70,210 @@ TransportRouter::TransportRouter(RoutingSettings settings, const TransportCatalo
   graph_ = graph::DirectedWeightedGraph<Minutes>(vertex_count);
   vertexes_.resize(vertex_count);
 
+  graph_.SetWeightParameters(MakeWeightParameters({}));
   AddStopsToGraph(cat);
   AddBusesToGraph(cat);
 
-  router_ = std::make_unique<graph::Router<Minutes>>(graph_);
+  // Сведения о явных рёбрах переставляются вслед за рёбрами графа
+  const auto edge_order = graph_.Freeze();
+  std::vector<EdgeInfo> edges;
+  edges.reserve(edge_order.size());
+  for (const graph::EdgeId edge_id : edge_order) {
+    edges.push_back(std::move(edges_[edge_id]));
+  }
+  edges_ = std::move(edges);
+
+  components_ = graph::ConnectedComponents(graph_);
+  if (settings_.hub_labels) {
+    hub_labels_ = std::make_shared<graph::HubLabels<Minutes>>(graph_);
+  }
+  UpdateRouterPtr(cat);
+  ResetRouteCache();
+}
+
+void TransportRouter::UpdateRouterPtr(const TransportCatalogue &cat) {
+  switch (settings_.router_type) {
+    case RouterType::ALL_PAIRS:
+      router_ = std::make_unique<graph::Router<Minutes>>(graph_,
+        GetThreadCount());
+      break;
+    case RouterType::DIJKSTRA:
+      router_ = std::make_unique<graph::DijkstraRouter<Minutes>>(graph_);
+      break;
+    case RouterType::CONTRACTION_HIERARCHY:
+      router_ =
+        std::make_unique<graph::ContractionHierarchy<Minutes>>(graph_);
+      break;
+    case RouterType::RAPTOR:
+      router_ = std::make_unique<graph::RaptorRouter<Minutes>>(graph_);
+      break;
+    case RouterType::A_STAR:
+    case RouterType::BIDIRECTIONAL_A_STAR:
+      router_ = std::make_unique<graph::AStarRouter<Minutes>>(graph_,
+        MakeGeoLowerBound(cat),
+        settings_.router_type == RouterType::BIDIRECTIONAL_A_STAR);
+      break;
+    case RouterType::ALT:
+      if (!landmarks_) {
+        landmarks_ = std::make_shared<graph::Landmarks<Minutes>>(graph_,
+          settings_.landmark_count);
+      }
+      router_ = std::make_unique<graph::AStarRouter<Minutes>>(graph_,
+        [landmarks = landmarks_](graph::VertexId from, graph::VertexId to) {
+          return landmarks->GetLowerBound(from, to);
+        });
+      break;
+    case RouterType::AUTO:
+      settings_.router_type = SelectRouterType();
+      is_router_type_selected_ = true;
+      UpdateRouterPtr(cat);
+      break;
+  }
+}
+
+// Оценки памяти сравниваются с бюджетом до построения движка, поэтому
+// неудачная настройка большой сети приводит к более медленному поиску, а не
+// к нехватке памяти
+RouterType TransportRouter::SelectRouterType() const {
+  const size_t memory_budget = settings_.memory_budget == 0
+    ? std::numeric_limits<size_t>::max() : settings_.memory_budget;
+
+  if (graph_.GetVertexCount() <= ALL_PAIRS_VERTEX_LIMIT
+    && graph::Router<Minutes>::EstimateMemoryUsage(graph_) <= memory_budget) {
+    return RouterType::ALL_PAIRS;
+  }
+  if (graph::ContractionHierarchy<Minutes>::EstimateMemoryUsage(graph_)
+    <= memory_budget) {
+    return RouterType::CONTRACTION_HIERARCHY;
+  }
+  return RouterType::DIJKSTRA;
+}
+
+void TransportRouter::ReportBuildStats(std::ostream &out) const {
+  using namespace std::string_view_literals;
+
+  if (is_router_type_selected_) {
+    out << "Router: "sv << GetRouterTypeName(settings_.router_type)
+      << " (selected automatically, memory budget: "sv;
+    if (settings_.memory_budget == 0) {
+      out << "unlimited)\n"sv;
+    } else {
+      out << settings_.memory_budget << " bytes)\n"sv;
+    }
+  }
+
+  out << "Graph: "sv << graph_.GetVertexCount() << " vertices, "sv
+    << graph_.GetEdgeCount() << " edges, memory: "sv
+    << graph_.GetMemoryUsage() << " bytes\n"sv;
+  if (source_line_count_ > 0) {
+    const size_t line_edge_count =
+      graph_.GetEdgeCount() - graph_.GetExplicitEdgeCount();
+    out << "Bus lines: "sv << graph_.GetLines().size() << " of "sv
+      << source_line_count_ << ", line edges: "sv << line_edge_count
+      << " of "sv << source_edge_count_ << " ("sv
+      << source_edge_count_ - line_edge_count << " duplicates removed)\n"sv;
+  }
+  out << "Connected components: "sv << components_.GetComponentCount()
+    << '\n';
+  if (landmarks_) {
+    out << "Landmarks: "sv << landmarks_->GetLandmarkCount()
+      << ", memory: "sv << landmarks_->GetMemoryUsage() << " bytes\n"sv;
+  }
+  if (hub_labels_) {
+    out << "Hub labels: average size "sv << hub_labels_->GetAverageLabelSize()
+      << ", max size "sv << hub_labels_->GetMaxLabelSize() << ", memory: "sv
+      << hub_labels_->GetMemoryUsage() << " bytes\n"sv;
+  }
+}
+
+void TransportRouter::ResetRouteCache() {
+  if (settings_.route_cache_capacity == 0) {
+    route_cache_.reset();
+  } else {
+    route_cache_ = std::make_unique<RouteCache>(settings_.route_cache_capacity);
+  }
+}
+
+void TransportRouter::ReportQueryStats(std::ostream &out) const {
+  using namespace std::string_view_literals;
+
+  if (route_cache_) {
+    out << "Route cache: "sv << route_cache_->GetSize() << '/'
+      << route_cache_->GetCapacity() << " routes, hits: "sv
+      << route_cache_->GetHitCount() << ", misses: "sv
+      << route_cache_->GetMissCount() << '\n';
+  }
+}
+
+// Потоков не больше, чем ядер: лишние только делят те же ядра
+size_t TransportRouter::GetThreadCount() const {
+  const size_t core_count = std::max(std::thread::hardware_concurrency(), 1u);
+  if (settings_.thread_count != 0) {
+    return std::min<size_t>(settings_.thread_count, core_count);
+  }
+  return core_count;
+}
+
+// Нижняя оценка времени поездки по длине хорды между остановками. Дорожное
+// расстояние может быть меньше расстояния по прямой, поэтому длина хорды
+// умножается на наименьшее отношение дорожного расстояния к хорде среди
+// соседних остановок всех маршрутов. По неравенству треугольника такая оценка
+// не превышает время любого пути и согласована для каждого ребра
+graph::AStarRouter<Minutes>::LowerBound
+TransportRouter::MakeGeoLowerBound(const TransportCatalogue &cat) const {
+  static const double dr = 3.1415926535 / 180.;
+
+  std::vector<std::array<double, 3>> points(vertexes_.size());
+  for (size_t vertex = 0; vertex < vertexes_.size(); ++vertex) {
+    const auto coordinates = cat.GetCoordinates(vertexes_[vertex]->id);
+    const double lat = coordinates.lat * dr;
+    const double lng = coordinates.lng * dr;
+    points[vertex] = {
+      std::cos(lat) * std::cos(lng),
+      std::cos(lat) * std::sin(lng),
+      std::sin(lat)
+    };
+  }
+
+  auto compute_chord = [](const std::array<double, 3> &lhs,
+    const std::array<double, 3> &rhs) {
+    const double dx = lhs[0] - rhs[0];
+    const double dy = lhs[1] - rhs[1];
+    const double dz = lhs[2] - rhs[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz) * geo::r_Earth;
+  };
+
+  double min_ratio = std::numeric_limits<double>::infinity();
+  for (const auto &line : graph_.GetLines()) {
+    for (size_t position = 1; position < line.GetSize(); ++position) {
+      const double chord = compute_chord(points[line.from[position - 1]],
+        points[line.from[position]]);
+      if (chord > 0) {
+        const double length = static_cast<double>(
+          line.lengths[position] - line.lengths[position - 1]);
+        min_ratio = std::min(min_ratio, length / chord);
+      }
+    }
+  }
+  if (std::isinf(min_ratio)) {
+    min_ratio = 0;
+  }
+
+  // Небольшой запас компенсирует погрешность вычислений с плавающей точкой
+  const double scale = min_ratio * (1 - 1e-9) / graph_.GetWeightParameters().line_speed;
+  return [points = std::move(points), scale, compute_chord](
+    graph::VertexId from, graph::VertexId to) {
+    return Minutes(compute_chord(points[from], points[to]) * scale);
+  };
+}
+
+const graph::BaseRouter<Minutes> &TransportRouter::GetRouter() const {
+  return *router_;
 }
 
-void TransportRouter::UpdateRouterPtr() {
-  router_ = std::make_unique<graph::Router<Minutes>>(graph_);
+void TransportRouter::SetRouter(
+  std::unique_ptr<graph::BaseRouter<Minutes>> router) {
+  router_ = std::move(router);
 }
 
 const graph::DirectedWeightedGraph<Minutes> &TransportRouter::GetGraph() const {
@@ -36,12 +292,12 @@ RoutingSettings &TransportRouter::GetRoutingSettings() {
   return settings_;
 }
 
-const std::unordered_map<const Stop *, TransportRouter::StopVertexIds, Hasher> &
+const std::vector<TransportRouter::StopVertexIds> &
 TransportRouter::GetStopsVertexIds() const {
   return stops_vertex_ids_;
 }
 
-std::unordered_map<const Stop *, TransportRouter::StopVertexIds, Hasher> &
+std::vector<TransportRouter::StopVertexIds> &
 TransportRouter::GetStopsVertexIds() {
   return stops_vertex_ids_;
 }
@@ -62,12 +318,264 @@ std::vector<TransportRouter::EdgeInfo> &TransportRouter::GetEdges() {
   return edges_;
 }
 
+const std::vector<const Bus *> &TransportRouter::GetLineBuses() const {
+  return line_buses_;
+}
+
+std::vector<const Bus *> &TransportRouter::GetLineBuses() {
+  return line_buses_;
+}
+
+const std::vector<TransportRouter::CoveredLine> &
+TransportRouter::GetCoveredLines() const {
+  return covered_lines_;
+}
+
+std::vector<TransportRouter::CoveredLine> &TransportRouter::GetCoveredLines() {
+  return covered_lines_;
+}
+
+const graph::ConnectedComponents &TransportRouter::GetComponents() const {
+  return components_;
+}
+
+void TransportRouter::SetComponents(graph::ConnectedComponents components) {
+  components_ = std::move(components);
+}
+
+const graph::Landmarks<Minutes> *TransportRouter::GetLandmarks() const {
+  return landmarks_.get();
+}
+
+void TransportRouter::SetLandmarks(
+  std::shared_ptr<const graph::Landmarks<Minutes>> landmarks) {
+  landmarks_ = std::move(landmarks);
+}
+
+const graph::HubLabels<Minutes> *TransportRouter::GetHubLabels() const {
+  return hub_labels_.get();
+}
+
+void TransportRouter::SetHubLabels(
+  std::shared_ptr<const graph::HubLabels<Minutes>> hub_labels) {
+  hub_labels_ = std::move(hub_labels);
+}
+
+void TransportRouter::SetBatchOverrides(RoutingOverrides overrides) {
+  batch_overrides_ = std::move(overrides);
+}
+
+// Вес ожидания хранится в графе как одно ожидание, длины линий - в метрах,
+// поэтому параметры пересчитывают их в минуты
+graph::WeightParameters TransportRouter::MakeWeightParameters(
+  const RoutingOverrides &overrides) const {
+  const auto bus_wait_time = overrides.bus_wait_time.value_or(
+    batch_overrides_.bus_wait_time.value_or(settings_.bus_wait_time));
+  const double bus_velocity = overrides.bus_velocity.value_or(
+    batch_overrides_.bus_velocity.value_or(settings_.bus_velocity));
+
+  graph::WeightParameters parameters;
+  parameters.line_speed = bus_velocity * 1000.0 / 60;
+  parameters.explicit_weight_scale =
+    static_cast<double>(bus_wait_time.count());
+  return parameters;
+}
+
+// Закрытия переводятся в рёбра графа. Рёбра закрытой линии, повторяющие
+// линию открытого автобуса, остаются открытыми
+void TransportRouter::SetClosures(Closures closures) {
+  std::vector<graph::VertexId> closed_vertices;
+  for (const Stop *stop : closures.stops) {
+    const auto &vertex_ids = stops_vertex_ids_[stop->id];
+    closed_vertices.push_back(vertex_ids.in);
+    closed_vertices.push_back(vertex_ids.out);
+  }
+
+  std::vector<size_t> closed_lines;
+  for (size_t line_id = 0; line_id < line_buses_.size(); ++line_id) {
+    if (closures.buses.count(line_buses_[line_id]) > 0) {
+      closed_lines.push_back(line_id);
+    }
+  }
+
+  std::vector<graph::LineEdge> open_spans;
+  for (const auto &[bus, line, begin, end] : covered_lines_) {
+    if (closures.buses.count(bus) == 0) {
+      open_spans.push_back({line, begin, end});
+    }
+  }
+
+  closed_edges_ = graph::ClosedEdges(graph_, closed_vertices, closed_lines,
+    open_spans);
+  closures_ = std::move(closures);
+}
+
+void TransportRouter::ClearClosures() {
+  closures_ = {};
+  closed_edges_ = {};
+}
+
+const Closures &TransportRouter::GetClosures() const {
+  return closures_;
+}
+
+bool TransportRouter::IsStopClosed(const Stop *stop) const {
+  return closures_.stops.count(stop) > 0;
+}
+
 std::optional<RouteInfo>
-TransportRouter::FindRoute(const Stop *from, const Stop *to) const {
-  const graph::VertexId vertex_from = stops_vertex_ids_.at(from).out;
-  const graph::VertexId vertex_to = stops_vertex_ids_.at(to).out;
-  const auto route = router_->BuildRoute(vertex_from, vertex_to);
+TransportRouter::FindRoute(const Stop *from, const Stop *to,
+  const RoutingOverrides &overrides) const {
+  const graph::VertexId vertex_from = stops_vertex_ids_[from->id].out;
+  const graph::VertexId vertex_to = stops_vertex_ids_[to->id].out;
+
+  // Остановки из разных компонент графа отклоняются без поиска
+  if (!components_.MayBeConnected(vertex_from, vertex_to)
+    || IsStopClosed(from) || IsStopClosed(to)) {
+    return std::nullopt;
+  }
+
+  const auto &base_parameters = graph_.GetWeightParameters();
+  if (const auto parameters = MakeWeightParameters(overrides);
+    parameters != base_parameters || !closed_edges_.IsEmpty()) {
+    return BuildRouteInfo(graph::BuildShortestRoute(graph_, vertex_from,
+      vertex_to, parameters, closed_edges_), parameters);
+  }
+
+  if (!route_cache_) {
+    return BuildRouteInfo(router_->BuildRoute(vertex_from, vertex_to),
+      base_parameters);
+  }
+
+  const RouteCacheKey key =
+    static_cast<RouteCacheKey>(vertex_from) << 32 | vertex_to;
+  if (auto cached_route = route_cache_->Get(key)) {
+    return std::move(*cached_route);
+  }
+
+  auto route_info = BuildRouteInfo(router_->BuildRoute(vertex_from,
+    vertex_to), base_parameters);
+  route_cache_->Put(key, route_info);
+  return route_info;
+}
+
+std::optional<Minutes> TransportRouter::FindRouteTime(const Stop *from,
+  const Stop *to, const RoutingOverrides &overrides) const {
+  if (hub_labels_ && closed_edges_.IsEmpty()
+    && MakeWeightParameters(overrides) == graph_.GetWeightParameters()) {
+    return hub_labels_->GetDistance(stops_vertex_ids_[from->id].out,
+      stops_vertex_ids_[to->id].out);
+  }
 
+  const auto route = FindRoute(from, to, overrides);
+  if (!route) {
+    return std::nullopt;
+  }
+  return route->total_time;
+}
+
+RouteMatrix TransportRouter::FindRouteMatrix(const std::vector<const Stop *> &from,
+  const std::vector<const Stop *> &to,
+  const RoutingOverrides &overrides) const {
+  const auto parameters = MakeWeightParameters(overrides);
+  std::vector<graph::VertexId> targets;
+  targets.reserve(to.size());
+  for (const Stop *stop : to) {
+    targets.push_back(stops_vertex_ids_[stop->id].out);
+  }
+
+  RouteMatrix matrix;
+  matrix.total_times.resize(from.size());
+  std::atomic<size_t> next_row{0};
+
+  // Поиск ведётся только до целей из компоненты начальной остановки: иначе
+  // недостижимая цель заставила бы обойти всю компоненту
+  auto fill_rows = [&]() {
+    std::vector<graph::VertexId> row_targets;
+    std::vector<size_t> row_columns;
+    for (size_t row = next_row++; row < from.size(); row = next_row++) {
+      const graph::VertexId source = stops_vertex_ids_[from[row]->id].out;
+      row_targets.clear();
+      row_columns.clear();
+      for (size_t column = 0; column < targets.size(); ++column) {
+        if (components_.MayBeConnected(source, targets[column])
+          && !IsStopClosed(from[row]) && !IsStopClosed(to[column])) {
+          row_targets.push_back(targets[column]);
+          row_columns.push_back(column);
+        }
+      }
+
+      auto &row_times = matrix.total_times[row];
+      row_times.assign(targets.size(), std::nullopt);
+      if (row_targets.empty()) {
+        continue;
+      }
+      const auto weights =
+        graph::BuildRouteWeights(graph_, source, row_targets, parameters,
+          closed_edges_);
+      for (size_t i = 0; i < row_columns.size(); ++i) {
+        row_times[row_columns[i]] = weights[i];
+      }
+    }
+  };
+
+  const size_t thread_count = std::min(GetThreadCount(), from.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers.emplace_back(fill_rows);
+  }
+  fill_rows();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  return matrix;
+}
+
+std::vector<ReachableStop>
+TransportRouter::FindReachableStops(const Stop *from, Minutes max_time,
+  const RoutingOverrides &overrides) const {
+  if (IsStopClosed(from)) {
+    return {};
+  }
+
+  const auto vertices = graph::BuildReachableVertices(graph_,
+    stops_vertex_ids_[from->id].out, max_time,
+    MakeWeightParameters(overrides), closed_edges_);
+
+  // Маршруты заканчиваются в выходных вершинах остановок, как и в FindRoute
+  std::vector<ReachableStop> stops;
+  for (const auto &[vertex, total_time] : vertices) {
+    const Stop *stop = vertexes_[vertex];
+    if (stops_vertex_ids_[stop->id].out == vertex) {
+      stops.push_back({stop, total_time});
+    }
+  }
+  return stops;
+}
+
+const Bus *
+TransportRouter::GetLineEdgeBus(const graph::LineEdge &line_edge) const {
+  const Bus *bus = line_buses_[line_edge.line];
+  if (closures_.buses.count(bus) == 0) {
+    return bus;
+  }
+
+  // Открытое ребро закрытой линии лежит внутри участка открытого автобуса
+  for (const auto &covered_line : covered_lines_) {
+    if (covered_line.line == line_edge.line
+      && covered_line.begin <= line_edge.begin
+      && line_edge.end <= covered_line.end
+      && closures_.buses.count(covered_line.bus) == 0) {
+      return covered_line.bus;
+    }
+  }
+  return bus;
+}
+
+std::optional<RouteInfo> TransportRouter::BuildRouteInfo(
+  const std::optional<graph::BaseRouter<Minutes>::RouteInfo> &route,
+  const graph::WeightParameters &parameters) const {
   if (!route) {
     return std::nullopt;
   }
@@ -77,9 +585,19 @@ TransportRouter::FindRoute(const Stop *from, const Stop *to) const {
   route_info.items.reserve(route->edges.size());
 
   for (const auto edge_id : route->edges) {
-    const auto &edge = graph_.GetEdge(edge_id);
-    const auto &bus_edge_info = edges_[edge_id];
+    const auto edge = graph_.GetEdge(edge_id, parameters);
 
+    // Неявные рёбра линий соответствуют поездкам на автобусе линии
+    if (const auto line_edge = graph_.GetLineEdge(edge_id)) {
+      route_info.items.emplace_back(RouteInfo::BusItem{
+        GetLineEdgeBus(*line_edge),
+        edge.weight,
+        line_edge->end - line_edge->begin,
+      });
+      continue;
+    }
+
+    const auto &bus_edge_info = edges_[edge_id];
     if (bus_edge_info.has_value()) {
       route_info.items.emplace_back(RouteInfo::BusItem{
         bus_edge_info->bus,
@@ -97,62 +615,139 @@ TransportRouter::FindRoute(const Stop *from, const Stop *to) const {
   return route_info;
 }
 
+// Номера вершин видны только внутри маршрутизатора. При нумерации вдоль
+// кривой Гильберта географически близкие остановки получают близкие номера, и
+// поиски обращаются к меньшему числу строк кэша процессора
+std::vector<const Stop *>
+TransportRouter::GetOrderedStops(const TransportCatalogue &cat) const {
+  std::vector<const Stop *> stops;
+  for (const auto &stop : cat.GetStops()) {
+    stops.push_back(&stop);
+  }
+  if (settings_.vertex_order == VertexOrder::CATALOGUE || stops.empty()) {
+    return stops;
+  }
+
+  const auto [min_lat, max_lat] = std::minmax_element(stops.begin(), stops.end(),
+    [&cat](const Stop *lhs, const Stop *rhs) {
+      return cat.GetCoordinates(lhs->id).lat < cat.GetCoordinates(rhs->id).lat;
+    });
+  const auto [min_lng, max_lng] = std::minmax_element(stops.begin(), stops.end(),
+    [&cat](const Stop *lhs, const Stop *rhs) {
+      return cat.GetCoordinates(lhs->id).lng < cat.GetCoordinates(rhs->id).lng;
+    });
+  const double min_lat_value = cat.GetCoordinates((*min_lat)->id).lat;
+  const double min_lng_value = cat.GetCoordinates((*min_lng)->id).lng;
+  const double lat_range = cat.GetCoordinates((*max_lat)->id).lat - min_lat_value;
+  const double lng_range = cat.GetCoordinates((*max_lng)->id).lng - min_lng_value;
+
+  // Координаты переводятся в решётку по охватывающему прямоугольнику
+  auto to_grid = [](double value, double range) {
+    constexpr double max_cell = (1u << 16) - 1;
+    return static_cast<uint32_t>(range > 0 ? value / range * max_cell : 0);
+  };
+  std::vector<std::pair<uint64_t, const Stop *>> indexed_stops;
+  indexed_stops.reserve(stops.size());
+  for (const Stop *stop : stops) {
+    const auto coordinates = cat.GetCoordinates(stop->id);
+    indexed_stops.emplace_back(GetHilbertIndex(
+      to_grid(coordinates.lng - min_lng_value, lng_range),
+      to_grid(coordinates.lat - min_lat_value, lat_range)), stop);
+  }
+  std::stable_sort(indexed_stops.begin(), indexed_stops.end(),
+    [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+  for (size_t i = 0; i < stops.size(); ++i) {
+    stops[i] = indexed_stops[i].second;
+  }
+  return stops;
+}
+
 void TransportRouter::AddStopsToGraph(const TransportCatalogue &cat) {
   graph::VertexId vertex_id = 0;
-  const auto &stops = cat.GetStops();
 
-  for (const auto &stop : stops) {
-    auto &vertex_ids = stops_vertex_ids_[&stop];
+  stops_vertex_ids_.resize(cat.GetStops().size());
+  for (const Stop *stop : GetOrderedStops(cat)) {
+    auto &vertex_ids = stops_vertex_ids_[stop->id];
 
     vertex_ids.in = vertex_id++;
     vertex_ids.out = vertex_id++;
-    vertexes_[vertex_ids.in] = &stop;
-    vertexes_[vertex_ids.out] = &stop;
+    vertexes_[vertex_ids.in] = stop;
+    vertexes_[vertex_ids.out] = stop;
 
     edges_.emplace_back(std::nullopt);
     graph_.AddEdge({
       vertex_ids.out,
       vertex_ids.in,
-      Minutes(settings_.bus_wait_time.count())
+      Minutes(1)  // Одно ожидание, в минуты переводится параметрами весов
     });
   }
 }
 
+// Каждый автобус добавляется в граф линией: рёбра между всеми парами
+// остановок маршрута не хранятся, а вычисляются по накопленным расстояниям.
+// Линии, повторяющие участок другой линии, в граф не добавляются: поездки по
+// ним совпадают по времени и числу остановок с поездками на автобусе
+// покрывающей линии, который и указывается в маршруте
 void TransportRouter::AddBusesToGraph(const TransportCatalogue &cat) {
   const auto &buses = cat.GetBuses();
 
+  std::vector<graph::EdgeLine> lines;
+  std::vector<const Bus *> line_buses;
+
   for (const auto &bus : buses) {
-    const auto &bus_stops = bus.stops;
-    const size_t stop_count = bus_stops.size();
+    const StopId *bus_stops = cat.GetRoute(bus.id).begin();
+    const size_t stop_count = bus.route_size;
 
     if (stop_count <= 1) {
       continue;
     }
 
-    auto compute_distance_from = [&cat, &bus_stops](size_t stop_idx) {
-      return cat.GetDistance(bus_stops[stop_idx], bus_stops[stop_idx + 1]);
-    };
+    graph::EdgeLine line;
+    line.from.reserve(stop_count);
+    line.to.reserve(stop_count);
+    line.lengths.reserve(stop_count);
 
-    for (size_t begin_i = 0; begin_i + 1 < stop_count; ++begin_i) {
-      const graph::VertexId start = stops_vertex_ids_.at(bus_stops[begin_i]).in;
-      size_t total_distance = 0;
+    uint64_t total_distance = 0;
+    for (size_t stop_i = 0; stop_i < stop_count; ++stop_i) {
+      if (stop_i > 0) {
+        total_distance +=
+          cat.GetDistance(bus_stops[stop_i - 1], bus_stops[stop_i]);
+      }
 
-      for (size_t end_i = begin_i + 1; end_i < stop_count; ++end_i) {
-        total_distance += compute_distance_from(end_i - 1);
-        edges_.emplace_back(BusEdge{
-          &bus,
-          end_i - begin_i,
-        });
+      const auto &vertex_ids = stops_vertex_ids_[bus_stops[stop_i]];
+      line.from.push_back(vertex_ids.in);
+      line.to.push_back(vertex_ids.out);
+      line.lengths.push_back(total_distance);
+    }
 
-        graph_.AddEdge({
-          start,
-          stops_vertex_ids_.at(bus_stops[end_i]).out,
-          Minutes(
-            static_cast<double>(total_distance)
-              / (settings_.bus_velocity * 1000.0 / 60)
-          )
-        });
-      }
+    lines.push_back(std::move(line));
+    line_buses.push_back(&bus);
+  }
+
+  const auto covered_lines = graph::FindCoveredLines(lines);
+  source_line_count_ = lines.size();
+  source_edge_count_ = 0;
+  std::vector<size_t> graph_line_ids(lines.size());
+  for (size_t line_id = 0; line_id < lines.size(); ++line_id) {
+    const size_t size = lines[line_id].GetSize();
+    source_edge_count_ += size * (size - 1) / 2;
+    if (!covered_lines[line_id]) {
+      graph_line_ids[line_id] = graph_.AddLine(std::move(lines[line_id]));
+      line_buses_.push_back(line_buses[line_id]);
+    }
+  }
+
+  // Участки, повторённые непопавшими в граф линиями, нужны для закрытий
+  // автобусов
+  for (size_t line_id = 0; line_id < lines.size(); ++line_id) {
+    if (const auto &window = covered_lines[line_id]) {
+      const size_t size = lines[line_id].GetSize();
+      covered_lines_.push_back({line_buses[line_id],
+        graph_line_ids[window->line], window->offset,
+        window->offset + size - 1});
     }
   }
 }
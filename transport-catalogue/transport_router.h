@@ -1,13 +1,25 @@
 #pragma once
 
+#include "astar_router.h"
+#include "closed_edges.h"
+#include "connected_components.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
 #include "domain.h"
 #include "graph.h"
+#include "hub_labels.h"
+#include "landmarks.h"
+#include "lru_cache.h"
+#include "raptor_router.h"
 #include "router.h"
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <ostream>
 #include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -15,9 +27,49 @@ class TransportCatalogue;
 
 namespace tc::router {
 
+// Движок поиска маршрутов
+enum class RouterType {
+  ALL_PAIRS,  // Таблица кратчайших путей между всеми парами вершин
+  DIJKSTRA,   // Поиск Дейкстры на каждый запрос без предварительного расчёта
+  CONTRACTION_HIERARCHY,  // Иерархия сжатия графа и двунаправленный поиск
+  RAPTOR,     // Поиск по раундам посадок вдоль маршрутов автобусов
+  A_STAR,     // Поиск A* с географической нижней оценкой времени
+  BIDIRECTIONAL_A_STAR,  // Двунаправленный поиск A*
+  ALT,        // Поиск A* с оценками по расстояниям до ориентиров
+  AUTO,       // Выбор движка по размеру графа и бюджету памяти
+};
+
+// Порядок нумерации вершин графа
+enum class VertexOrder {
+  CATALOGUE,  // В порядке добавления остановок в справочник
+  HILBERT,    // Вдоль кривой Гильберта по координатам остановок
+};
+
 struct RoutingSettings {
   std::chrono::minutes bus_wait_time{};
   double bus_velocity = 0;
+  RouterType router_type = RouterType::ALL_PAIRS;
+  uint32_t thread_count = 0;  // Число потоков расчёта, 0 - по числу ядер
+  uint32_t landmark_count = 16;  // Число ориентиров для RouterType::ALT
+  uint32_t route_cache_capacity = 0;  // Размер кэша маршрутов, 0 - без кэша
+  VertexOrder vertex_order = VertexOrder::CATALOGUE;
+  bool hub_labels = false;  // Строить метки хабов для запросов времени в пути
+  size_t memory_budget = 0;  // Память движка для RouterType::AUTO, 0 - любая
+};
+
+// Параметры маршрутизации, переопределяемые для пакета запросов или
+// отдельного запроса без перестроения базы
+struct RoutingOverrides {
+  std::optional<std::chrono::minutes> bus_wait_time;
+  std::optional<double> bus_velocity;
+};
+
+// Остановки и автобусы, закрытые без перестроения базы: на закрытой
+// остановке нельзя сесть в автобус и выйти из него, закрытые автобусы не
+// используются в маршрутах
+struct Closures {
+  std::unordered_set<const Stop *, Hasher> stops;
+  std::unordered_set<const Bus *, Hasher> buses;
 };
 
 using Minutes = std::chrono::duration<double, std::chrono::minutes::period>;
@@ -40,6 +92,18 @@ struct RouteInfo {
   std::vector<Item> items;
 };
 
+// Время в пути между наборами остановок: total_times[i][j] - от i-й начальной
+// остановки до j-й конечной, nullopt - маршрута нет
+struct RouteMatrix {
+  std::vector<std::vector<std::optional<Minutes>>> total_times;
+};
+
+// Остановка, достижимая за заданное время, и время в пути до неё
+struct ReachableStop {
+  const Stop *stop;
+  Minutes total_time;
+};
+
 class TransportRouter {
 public:
   struct StopVertexIds {
@@ -54,12 +118,71 @@ public:
 
   using EdgeInfo = std::optional<BusEdge>;
 
+  // Линия автобуса, не добавленная в граф, так как повторяет участок
+  // [begin, end] линии графа line
+  struct CoveredLine {
+    const Bus *bus;
+    size_t line;
+    size_t begin;
+    size_t end;
+  };
+
   TransportRouter() = default;
   TransportRouter(RoutingSettings settings, const TransportCatalogue &cat);
 
-  std::optional<RouteInfo> FindRoute(const Stop *from, const Stop *to) const;
+  // Результаты поиска, в том числе отсутствие маршрута, сохраняются в кэше
+  // маршрутов, если он включён в настройках. Если переопределения запроса
+  // или пакета меняют веса рёбер или действуют закрытия, маршрут ищется
+  // поиском Дейкстры по тому же графу и не кэшируется: предварительные
+  // расчёты движков верны только для параметров и сети базы
+  std::optional<RouteInfo> FindRoute(const Stop *from, const Stop *to,
+    const RoutingOverrides &overrides = {}) const;
+
+  // Время в пути без описания маршрута. Если построены метки хабов и запрос
+  // идёт с параметрами и сетью базы, время находится слиянием меток без
+  // поиска, иначе - поиском маршрута, как в FindRoute
+  std::optional<Minutes> FindRouteTime(const Stop *from, const Stop *to,
+    const RoutingOverrides &overrides = {}) const;
+
+  // Матрица времени в пути из каждой остановки from до каждой остановки to.
+  // Для каждой начальной остановки выполняется один поиск до всех конечных,
+  // поиски распределяются между потоками
+  RouteMatrix FindRouteMatrix(const std::vector<const Stop *> &from,
+    const std::vector<const Stop *> &to,
+    const RoutingOverrides &overrides = {}) const;
+
+  // Остановки, до которых можно добраться из from не более чем за max_time,
+  // в порядке возрастания времени в пути. Выполняется одним поиском,
+  // ограниченным max_time
+  std::vector<ReachableStop> FindReachableStops(const Stop *from,
+    Minutes max_time, const RoutingOverrides &overrides = {}) const;
+
+  // Переопределения для всех последующих запросов. Переопределения
+  // отдельного запроса имеют приоритет
+  void SetBatchOverrides(RoutingOverrides overrides);
 
-  void UpdateRouterPtr();
+  // Заменяет набор закрытых остановок и автобусов. Предварительные расчёты
+  // движков и кэш маршрутов сохраняются и используются снова после снятия
+  // закрытий
+  void SetClosures(Closures closures);
+  void ClearClosures();
+  const Closures &GetClosures() const;
+
+  // Справочник нужен движкам с оценками по координатам остановок
+  void UpdateRouterPtr(const TransportCatalogue &cat);
+
+  // Создаёт пустой кэш маршрутов по текущим настройкам. Должен вызываться
+  // после любого изменения графа или настроек, влияющего на маршруты
+  void ResetRouteCache();
+
+  // Печатает сведения о предварительном расчёте маршрутизатора
+  void ReportBuildStats(std::ostream &out) const;
+
+  // Печатает статистику обработки запросов маршрутов
+  void ReportQueryStats(std::ostream &out) const;
+
+  const graph::BaseRouter<Minutes> &GetRouter() const;
+  void SetRouter(std::unique_ptr<graph::BaseRouter<Minutes>> router);
 
   const graph::DirectedWeightedGraph<Minutes> &GetGraph() const;
   graph::DirectedWeightedGraph<Minutes> &GetGraph();
@@ -67,10 +190,9 @@ public:
   const RoutingSettings &GetRoutingSettings() const;
   RoutingSettings &GetRoutingSettings();
 
-  const std::unordered_map<const Stop *, StopVertexIds, Hasher> &
-  GetStopsVertexIds() const;
-  std::unordered_map<const Stop *, StopVertexIds, Hasher> &
-  GetStopsVertexIds();
+  // Вершины остановок по их номерам в справочнике
+  const std::vector<StopVertexIds> &GetStopsVertexIds() const;
+  std::vector<StopVertexIds> &GetStopsVertexIds();
 
   const std::vector<const Stop *> &GetVertexes() const;
   std::vector<const Stop *> &GetVertexes();
@@ -78,16 +200,80 @@ public:
   const std::vector<EdgeInfo> &GetEdges() const;
   std::vector<EdgeInfo> &GetEdges();
 
+  const std::vector<const Bus *> &GetLineBuses() const;
+  std::vector<const Bus *> &GetLineBuses();
+
+  const std::vector<CoveredLine> &GetCoveredLines() const;
+  std::vector<CoveredLine> &GetCoveredLines();
+
+  const graph::ConnectedComponents &GetComponents() const;
+  void SetComponents(graph::ConnectedComponents components);
+
+  const graph::Landmarks<Minutes> *GetLandmarks() const;
+  void SetLandmarks(std::shared_ptr<const graph::Landmarks<Minutes>> landmarks);
+
+  const graph::HubLabels<Minutes> *GetHubLabels() const;
+  void SetHubLabels(std::shared_ptr<const graph::HubLabels<Minutes>> hub_labels);
+
 private:
+  // Ключ кэша маршрутов из номеров начальной и конечной вершин
+  using RouteCacheKey = uint64_t;
+  using RouteCache = cache::LruCache<RouteCacheKey, std::optional<RouteInfo>>;
+
+  // Параметры весов рёбер по настройкам базы с учётом переопределений пакета
+  // и запроса
+  graph::WeightParameters MakeWeightParameters(
+    const RoutingOverrides &overrides) const;
+
+  bool IsStopClosed(const Stop *stop) const;
+
+  // Автобус поездки по ребру линии: автобус линии или, если он закрыт,
+  // открытый автобус повторяющей участок линии
+  const Bus *GetLineEdgeBus(const graph::LineEdge &line_edge) const;
+
+  std::optional<RouteInfo> BuildRouteInfo(
+    const std::optional<graph::BaseRouter<Minutes>::RouteInfo> &route,
+    const graph::WeightParameters &parameters) const;
+
+  // Движок для RouterType::AUTO: самый быстрый на запросах из тех, что
+  // укладываются в бюджет памяти. Выбранный движок заменяет AUTO в
+  // настройках и сохраняется в базе
+  RouterType SelectRouterType() const;
+
+  size_t GetThreadCount() const;
+  graph::AStarRouter<Minutes>::LowerBound
+  MakeGeoLowerBound(const TransportCatalogue &cat) const;
+
+  // Остановки в порядке нумерации их вершин
+  std::vector<const Stop *> GetOrderedStops(const TransportCatalogue &cat) const;
+
   void AddStopsToGraph(const TransportCatalogue &cat);
   void AddBusesToGraph(const TransportCatalogue &cat);
 
+  // Таблица всех пар строится за O(V^3), поэтому при автоматическом выборе
+  // она рассматривается только для небольших графов
+  static constexpr size_t ALL_PAIRS_VERTEX_LIMIT = 4000;
+
   RoutingSettings settings_;
+  bool is_router_type_selected_ = false;
   graph::DirectedWeightedGraph<Minutes> graph_;
-  std::unique_ptr<graph::Router<Minutes>> router_;
-  std::unordered_map<const Stop *, StopVertexIds, Hasher> stops_vertex_ids_;
+  std::unique_ptr<graph::BaseRouter<Minutes>> router_;
+  std::vector<StopVertexIds> stops_vertex_ids_;
   std::vector<const Stop *> vertexes_;
-  std::vector<EdgeInfo> edges_;
+  std::vector<EdgeInfo> edges_;       // Сведения о явных рёбрах графа
+  std::vector<const Bus *> line_buses_;  // Автобус каждой линии графа
+  std::vector<CoveredLine> covered_lines_;
+
+  // Число линий и их рёбер до исключения повторяющих друг друга линий
+  size_t source_line_count_ = 0;
+  size_t source_edge_count_ = 0;
+  graph::ConnectedComponents components_;
+  std::shared_ptr<const graph::Landmarks<Minutes>> landmarks_;
+  std::shared_ptr<const graph::HubLabels<Minutes>> hub_labels_;
+  std::unique_ptr<RouteCache> route_cache_;
+  RoutingOverrides batch_overrides_;
+  Closures closures_;
+  graph::ClosedEdges closed_edges_;
 };
 
 }  // namespace tc::router